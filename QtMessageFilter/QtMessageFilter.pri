@@ -22,10 +22,14 @@
 #  SOFTWARE.
 #
 
+include($$PWD/QtMessageFilterCore.pri)
+
 QT += \
     core \
     gui
 
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
 SOURCES += \
     $$PWD/src/QtMessageFilter/qtmessagefilter.cpp
 
@@ -34,6 +38,3 @@ HEADERS += \
 
 RESOURCES += \
     $$PWD/share/QtMessageFilter/icons/icons.qrc
-
-INCLUDEPATH += \
-    $$PWD/src
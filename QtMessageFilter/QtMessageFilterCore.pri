@@ -0,0 +1,61 @@
+#
+# MIT License
+#
+# Copyright (c) 2020-2021  Bruno Bollos Correa
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+#
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+#
+
+# Engine of QtMessageFilter (message handler, retention of the messages and
+#  log file), it only depends on QtCore and QtConcurrent. Include this file
+#  instead of QtMessageFilter.pri on headless applications.
+
+QT += \
+    core \
+    concurrent
+
+SOURCES += \
+    $$PWD/src/QtMessageFilter/qtmessagefiltercore.cpp \
+    $$PWD/src/QtMessageFilter/qtmessagefilterlogwriter.cpp \
+    $$PWD/src/QtMessageFilter/qtmessagefilterlogreader.cpp \
+    $$PWD/src/QtMessageFilter/qtmessagefiltersampler.cpp \
+    $$PWD/src/QtMessageFilter/qtmessagefilterprofiler.cpp \
+    $$PWD/src/QtMessageFilter/qtmessagefiltertemplateminer.cpp \
+    $$PWD/src/QtMessageFilter/qtmessagefilterstacktrace.cpp \
+    $$PWD/src/QtMessageFilter/qtmessagefiltersearch.cpp \
+    $$PWD/src/QtMessageFilter/qtmessagefilterpattern.cpp \
+    $$PWD/src/QtMessageFilter/qtmessagefilterlogfollower.cpp
+
+HEADERS += \
+    $$PWD/src/QtMessageFilter/qtmessagefiltercore.h \
+    $$PWD/src/QtMessageFilter/qtmessagefilterlogwriter.h \
+    $$PWD/src/QtMessageFilter/qtmessagefilterlogreader.h \
+    $$PWD/src/QtMessageFilter/qtmessagefiltersampler.h \
+    $$PWD/src/QtMessageFilter/qtmessagefilterprofiler.h \
+    $$PWD/src/QtMessageFilter/qtmessagefiltertemplateminer.h \
+    $$PWD/src/QtMessageFilter/qtmessagefilterstacktrace.h \
+    $$PWD/src/QtMessageFilter/qtmessagefiltersearch.h \
+    $$PWD/src/QtMessageFilter/qtmessagefilterpattern.h \
+    $$PWD/src/QtMessageFilter/qtmessagefilterlogfollower.h
+
+# dladdr() of the symbolization of the stacks (see QtMessageFilterStackTrace)
+linux: LIBS += -ldl
+
+INCLUDEPATH += \
+    $$PWD/src
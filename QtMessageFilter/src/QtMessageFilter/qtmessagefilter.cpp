@@ -33,19 +33,31 @@
 #include <QMutex>
 #include <QScrollBar>
 #include <QMessageBox>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QItemSelectionModel>
+#include <QHash>
+
+#include <algorithm>
 
 QtMessageFilter* QtMessageFilter::m_singleton_instance = nullptr;
 
-void QtMessageFilter::resetInstance(QWidget* parent, bool hide, const ulong maximumItensSize, const ulong maximumMessageDetailsSize)
+void QtMessageFilter::resetInstance(QWidget* parent, bool hide, const ulong maximumItensSize, const ulong maximumMessageDetailsSize,
+                                    const ulong maximumRetainedBytes, const ulong maximumMessageBytes)
 {
+    // Replaced by the budget of bytes, kept so the calls of older versions keep their meaning
+    Q_UNUSED(maximumMessageDetailsSize)
+
     delete QtMessageFilter::m_singleton_instance;
-    QtMessageFilter::m_singleton_instance = new QtMessageFilter(parent, maximumItensSize, maximumMessageDetailsSize);
+    QtMessageFilter::m_singleton_instance = nullptr;
+
+    // Install the message handler of the engine
+    QtMessageFilterCore::resetInstance(maximumRetainedBytes, maximumMessageBytes);
+
+    QtMessageFilter::m_singleton_instance = new QtMessageFilter(parent, maximumItensSize);
 
     if(!hide)
         QtMessageFilter::showDialog();
-
-    // Install the message handler of this class
-    qInstallMessageHandler(QtMessageFilter::f_message_filter);
 }
 
 void QtMessageFilter::releaseInstance()
@@ -55,6 +67,8 @@ void QtMessageFilter::releaseInstance()
 
     delete QtMessageFilter::m_singleton_instance;
     QtMessageFilter::m_singleton_instance = nullptr;
+
+    QtMessageFilterCore::releaseInstance();
 }
 
 bool QtMessageFilter::good()
@@ -77,7 +91,11 @@ void QtMessageFilter::hideDialog()
 void QtMessageFilter::showDialog()
 {
     if(QtMessageFilter::good())
+    {
+        // The widgets are only created the first time the dialog is shown
+        QtMessageFilter::f_instance()->f_configure_ui();
         QtMessageFilter::f_instance()->show();
+    }
     else
     {
         qWarning()<<"You tried to call a method of the class QtMessageFilter when it was inactive,"
@@ -111,6 +129,55 @@ void QtMessageFilter::setInstanceParent(QWidget* parent)
     }
 }
 
+void QtMessageFilter::setMessageTypeVisible(const QtMsgType type, const bool visible)
+{
+    if(!QtMessageFilter::good())
+    {
+        qWarning()<<"You tried to call a method of the class QtMessageFilter when it was inactive,"
+                    " please call QtMessageFilter::resetInstance before use any method of this class.\n"
+                    "Thanks.";
+        return;
+    }
+
+    // Same as clicking on the checkbox of the type
+    QtMessageFilter* filter = QtMessageFilter::f_instance();
+    filter->f_configure_ui();
+
+    switch(type)
+    {
+        case QtDebugMsg:
+            filter->m_cb_debug->setChecked(visible);
+            break;
+        case QtInfoMsg:
+            filter->m_cb_info->setChecked(visible);
+            break;
+        case QtWarningMsg:
+            filter->m_cb_warning->setChecked(visible);
+            break;
+        case QtCriticalMsg:
+            filter->m_cb_critical->setChecked(visible);
+            break;
+        default:
+            break;
+    }
+}
+
+void QtMessageFilter::followLogFile(const QString& fileName)
+{
+    if(!QtMessageFilter::good())
+    {
+        qWarning()<<"You tried to call a method of the class QtMessageFilter when it was inactive,"
+                    " please call QtMessageFilter::resetInstance before use any method of this class.\n"
+                    "Thanks.";
+        return;
+    }
+
+    // The messages of the file arrive as the captured ones
+    QtMessageFilterCore::followLogFile(fileName);
+
+    QtMessageFilter::f_instance()->f_update_window_title();
+}
+
 void QtMessageFilter::closeEvent(QCloseEvent* event)
 {
     Q_UNUSED(event)
@@ -120,86 +187,90 @@ void QtMessageFilter::closeEvent(QCloseEvent* event)
 void QtMessageFilter::hideEvent(QHideEvent* event)
 {
     Q_UNUSED(event)
-    m_current_dialog->hide();
+    f_set_rendering_enabled(false);
+    if(m_current_dialog)
+        m_current_dialog->hide();
+    if(m_top_talkers_dialog)
+        m_top_talkers_dialog->hide();
     this->QWidget::hide();
 }
 
+void QtMessageFilter::showEvent(QShowEvent* event)
+{
+    QDialog::showEvent(event);
+    f_configure_ui();
+    f_set_rendering_enabled(!this->isMinimized());
+}
+
+void QtMessageFilter::changeEvent(QEvent* event)
+{
+    QDialog::changeEvent(event);
+    if(event->type() == QEvent::WindowStateChange && this->isVisible())
+        f_set_rendering_enabled(!this->isMinimized());
+}
+
 void QtMessageFilter::reject()
 {
     this->hide();
 }
 
-QtMessageFilter::QtMessageFilter(QWidget *parent, const ulong maximumItensSize, const ulong maximumMessageDetailsSize)
+QtMessageFilter::QtMessageFilter(QWidget *parent, const ulong maximumItensSize)
     : QDialog(parent),
-      m_debug(),
-      m_info(),
-      m_warning(),
-      m_critical(),
-      m_last_id(0),
       m_list(),
-      m_vertical_layout_global(new QVBoxLayout(this)),
-      m_scroll_area(new QScrollArea(this)),
-      m_widget_scroll_area(new QWidget()),
-      m_vertical_layout_scroll_area(new QVBoxLayout(m_widget_scroll_area)),
-      m_horizontal_layout(new QHBoxLayout()),
-      m_horizontal_spacer(new QSpacerItem(40, 20, QSizePolicy::Expanding, QSizePolicy::Minimum)),
-      m_cb_debug(new QCheckBox(this)),
-      m_cb_info(new QCheckBox(this)),
-      m_cb_warning(new QCheckBox(this)),
-      m_cb_critical(new QCheckBox(this)),
-      m_current_dialog(new QDialog(this)),
-      m_current_dialog_vertical_layout(new QVBoxLayout(m_current_dialog)),
-      m_current_dialog_text(new QPlainTextEdit(m_current_dialog)),
-      m_log_file(new QFile()),
-      m_maximum_itens_size(maximumItensSize),
-      m_maximum_message_details_size(maximumMessageDetailsSize)
+      m_rendering_enabled(false),
+      m_connection_message_captured(),
+      m_ui_configured(false),
+      m_vertical_layout_global(nullptr),
+      m_scroll_area(nullptr),
+      m_widget_scroll_area(nullptr),
+      m_vertical_layout_scroll_area(nullptr),
+      m_horizontal_layout(nullptr),
+      m_horizontal_spacer(nullptr),
+      m_cb_debug(nullptr),
+      m_cb_info(nullptr),
+      m_cb_warning(nullptr),
+      m_cb_critical(nullptr),
+      m_combo_thread(nullptr),
+      m_thread_filter(0),
+      m_known_threads(),
+      m_cb_group_templates(nullptr),
+      m_tmr_group_templates(nullptr),
+      m_le_search(nullptr),
+      m_tmr_search(nullptr),
+      m_search(nullptr),
+      m_search_pending(),
+      m_label_statistics(nullptr),
+      m_tmr_statistics(nullptr),
+      m_pb_top_talkers(nullptr),
+      m_top_talkers_dialog(nullptr),
+      m_top_talkers_table(nullptr),
+      m_tmr_top_talkers(nullptr),
+      m_pb_follow(nullptr),
+      m_current_dialog(nullptr),
+      m_current_dialog_vertical_layout(nullptr),
+      m_current_dialog_text(nullptr),
+      m_maximum_itens_size(maximumItensSize)
 {
-    f_configure_ui();
+    // The widgets are created by f_configure_ui on the first call
+    //  of QtMessageFilter::showDialog, a hidden filter does not
+    //  pay for them
 
-    // Multi-thread support
-    qRegisterMetaType<QSharedPointer<MessageDetails>>();
+    // The messages captured are only connected to the dialog while
+    //  it is visible, see QtMessageFilter::f_set_rendering_enabled
 
-    // Multi-thread support, &QtMessageFilter::slot_create_message_item will be
-    //  always executed on the main thread
-    connect(this, &QtMessageFilter::signal_create_message_item,
-            this, &QtMessageFilter::slot_create_message_item,
-            Qt::QueuedConnection);
-
-    connect(this, &QtMessageFilter::signal_fatal_message,
+    connect(QtMessageFilterCore::instance(), &QtMessageFilterCore::signal_fatal_message,
             this, &QtMessageFilter::slot_fatal_message,
             Qt::QueuedConnection);
-
-    // Remove last log file, create a new one and let it be opened
-    m_log_file->setFileName("QtMessageFilterLog.txt");
-    if(m_log_file->remove())
-        m_log_file->setFileName("QtMessageFilterLog.txt");
-    m_log_file->open(QIODevice::WriteOnly);
-
-    // Log File Begin
-    {
-        QTextStream stream(m_log_file.get());
-        stream << "\\BEGIN " << QDateTime::currentDateTime().toString(Qt::ISODateWithMs)
-               << "\n\n\n";
-    }
 }
 
 QtMessageFilter::~QtMessageFilter()
 {
-    // Install the default message handler
-    qInstallMessageHandler(0);
-
     // We have a little memory leak problem here, but without this
     //  line of code, the application crashes on destructor. Since
     //  we are ending the application at this point, it should not
     //  be a problem
-    m_horizontal_layout->setParent(nullptr);
-
-    // Log File End
-    {
-        QTextStream stream(m_log_file.get());
-        stream << "\n\n\n"
-               << "\\END " << QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
-    }
+    if(m_horizontal_layout)
+        m_horizontal_layout->setParent(nullptr);
 }
 
 QtMessageFilter* QtMessageFilter::f_instance()
@@ -215,6 +286,34 @@ QtMessageFilter* QtMessageFilter::f_instance()
 
 void QtMessageFilter::f_configure_ui()
 {
+    if(m_ui_configured)
+        return;
+    m_ui_configured = true;
+
+    m_vertical_layout_global = new QVBoxLayout(this);
+    m_scroll_area = new QScrollArea(this);
+    m_widget_scroll_area = new QWidget();
+    m_vertical_layout_scroll_area = new QVBoxLayout(m_widget_scroll_area);
+    m_horizontal_layout = new QHBoxLayout();
+    m_horizontal_spacer = new QSpacerItem(40, 20, QSizePolicy::Expanding, QSizePolicy::Minimum);
+    m_cb_debug = new QCheckBox(this);
+    m_cb_info = new QCheckBox(this);
+    m_cb_warning = new QCheckBox(this);
+    m_cb_critical = new QCheckBox(this);
+    m_combo_thread = new QComboBox(this);
+    m_cb_group_templates = new QCheckBox(this);
+    m_tmr_group_templates = new QTimer(this);
+    m_le_search = new QLineEdit(this);
+    m_tmr_search = new QTimer(this);
+    m_search = new QtMessageFilterSearch(this);
+    m_label_statistics = new QLabel(this);
+    m_tmr_statistics = new QTimer(this);
+    m_pb_top_talkers = new QPushButton(this);
+    m_pb_follow = new QPushButton(this);
+    m_current_dialog = new QDialog(this);
+    m_current_dialog_vertical_layout = new QVBoxLayout(m_current_dialog);
+    m_current_dialog_text = new QPlainTextEdit(m_current_dialog);
+
     // Constant size of the checkboxes
     m_cb_debug->setFixedSize(20, 20);
     m_cb_info->setFixedSize(20, 20);
@@ -246,6 +345,11 @@ void QtMessageFilter::f_configure_ui()
     m_horizontal_layout->addItem(m_horizontal_spacer);
     m_horizontal_layout->addWidget(m_cb_critical);
     m_horizontal_layout->addItem(m_horizontal_spacer);
+    m_horizontal_layout->addWidget(m_combo_thread);
+    m_horizontal_layout->addWidget(m_le_search);
+    m_horizontal_layout->addWidget(m_cb_group_templates);
+    m_horizontal_layout->addWidget(m_pb_top_talkers);
+    m_horizontal_layout->addWidget(m_pb_follow);
 
 
 
@@ -257,8 +361,28 @@ void QtMessageFilter::f_configure_ui()
 
     m_vertical_layout_global->addLayout(m_horizontal_layout);
     m_vertical_layout_global->addWidget(m_scroll_area);
+    m_vertical_layout_global->addWidget(m_label_statistics);
     this->setLayout(m_vertical_layout_global);
 
+    // Status strip of the filter itself
+    m_label_statistics->setWordWrap(true);
+    m_label_statistics->setToolTip("Messages per second, bytes written on the log file, depth of its queue, "
+                                   "dropped messages, 99th percentile of the flushes of the log file and "
+                                   "messages not rendered yet");
+    m_pb_top_talkers->setText("Top talkers");
+    m_pb_top_talkers->setToolTip("Locations of the code that generated more messages");
+    connect(m_pb_top_talkers, &QPushButton::clicked,
+            this, &QtMessageFilter::f_show_top_talkers);
+
+    m_pb_follow->setText("Follow...");
+    m_pb_follow->setToolTip("Show the messages of a log file written by another process");
+    connect(m_pb_follow, &QPushButton::clicked,
+            this, &QtMessageFilter::f_follow_log_file);
+
+    m_tmr_statistics->setInterval(1000);
+    connect(m_tmr_statistics, &QTimer::timeout,
+            this, &QtMessageFilter::slot_update_statistics);
+
     // Maximum and minimum sizes of the dialog
     this->setMaximumSize(800, 1600);
     this->setMinimumSize(400, 500);
@@ -269,13 +393,13 @@ void QtMessageFilter::f_configure_ui()
     //  on the current state.
     // This signal is emmited whenever the state of the checkbox changes
     connect(m_cb_debug, &QCheckBox::stateChanged,
-            this, [this]{ if(m_cb_debug->isChecked()) f_set_message_of_type(QtDebugMsg); else f_unset_message_of_type(QtDebugMsg); });
+            this, [this]{ if(m_cb_debug->isChecked()) f_materialize_items(); else f_unset_message_of_type(QtDebugMsg); });
     connect(m_cb_info, &QCheckBox::stateChanged,
-            this, [this]{ if(m_cb_info->isChecked()) f_set_message_of_type(QtInfoMsg); else f_unset_message_of_type(QtInfoMsg);} );
+            this, [this]{ if(m_cb_info->isChecked()) f_materialize_items(); else f_unset_message_of_type(QtInfoMsg);} );
     connect(m_cb_warning, &QCheckBox::stateChanged,
-            this, [this]{ if(m_cb_warning->isChecked()) f_set_message_of_type(QtWarningMsg); else f_unset_message_of_type(QtWarningMsg); });
+            this, [this]{ if(m_cb_warning->isChecked()) f_materialize_items(); else f_unset_message_of_type(QtWarningMsg); });
     connect(m_cb_critical, &QCheckBox::stateChanged,
-            this, [this]{ if(m_cb_critical->isChecked()) f_set_message_of_type(QtCriticalMsg); else f_unset_message_of_type(QtCriticalMsg); });
+            this, [this]{ if(m_cb_critical->isChecked()) f_materialize_items(); else f_unset_message_of_type(QtCriticalMsg); });
 
     // Connect shortcuts to change the state of the checkboxes
     connect(new QShortcut(QKeySequence(Qt::Key_D), this), &QShortcut::activated,
@@ -289,7 +413,46 @@ void QtMessageFilter::f_configure_ui()
 
 
 
-    // Initialize with all checkboxes checked
+    // Show the messages of one thread or of all of them
+    m_combo_thread->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+    m_combo_thread->setToolTip("Thread of the messages");
+    f_update_thread_filter();
+    connect(m_combo_thread, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, [this]
+    {
+        m_thread_filter = (quintptr)m_combo_thread->currentData().toULongLong();
+        f_materialize_items();
+    });
+
+    // Collapse the messages of the same template, the new messages update
+    //  the groups with a little delay, see QtMessageFilter::slot_create_message_item
+    m_cb_group_templates->setText("Group");
+    m_cb_group_templates->setToolTip("Group the messages by their template");
+    m_tmr_group_templates->setSingleShot(true);
+    m_tmr_group_templates->setInterval(500);
+    connect(m_cb_group_templates, &QCheckBox::stateChanged,
+            this, &QtMessageFilter::f_materialize_items);
+    connect(m_tmr_group_templates, &QTimer::timeout,
+            this, &QtMessageFilter::f_materialize_items);
+
+    // Search on the retained messages, the items are created as the
+    //  results arrive
+    m_le_search->setPlaceholderText("Search");
+    m_le_search->setClearButtonEnabled(true);
+    m_le_search->setToolTip("Text of the messages, or a regular expression between slashes (/expression/)");
+    m_tmr_search->setSingleShot(true);
+    m_tmr_search->setInterval(250);
+    connect(m_le_search, &QLineEdit::textChanged,
+            m_tmr_search, QOverload<>::of(&QTimer::start));
+    connect(m_tmr_search, &QTimer::timeout,
+            this, &QtMessageFilter::f_materialize_items);
+    connect(m_search, &QtMessageFilterSearch::signal_results,
+            this, &QtMessageFilter::slot_search_results);
+    connect(m_search, &QtMessageFilterSearch::signal_finished,
+            this, &QtMessageFilter::slot_search_finished);
+
+    // Initialize with all checkboxes checked, the items are created
+    //  when the dialog is shown
     m_cb_debug->setChecked(true);
     m_cb_info->setChecked(true);
     m_cb_warning->setChecked(true);
@@ -300,120 +463,15 @@ void QtMessageFilter::f_configure_ui()
     m_current_dialog_text->setReadOnly(true);
     m_current_dialog->setWindowTitle("Message details");
 
-    this->setWindowTitle("Qt Message Filter");
+    // A file may already be followed before the dialog is shown the first time
+    f_update_window_title();
 }
 
-void QtMessageFilter::f_message_filter(const QtMsgType type, const QMessageLogContext& context, const QString& msg)
+void QtMessageFilter::f_update_window_title()
 {
-    if(QtMessageFilter::good())
-        QtMessageFilter::f_instance()->f_message_output(type, context, msg);
-}
-
-void QtMessageFilter::f_message_output(const QtMsgType type,
-                                       const QMessageLogContext& context,
-                                       const QString& msg)
-{
-    QSharedPointer<MessageDetails> messageInfo( new MessageDetails(type, context, msg, m_last_id++, QDateTime::currentDateTime()) );
-
-    QTextStream streamLog(m_log_file.get());
-
-    // Write message details on the log file
-    streamLog << "<<<<<<<<<<<<<<<" << messageInfo->id << "<<<<<<<<<<<<<<<\n";
-    streamLog << "\\origin:\n" <<
-                 messageInfo->fileName << " " << QString::number(messageInfo->line) << '\n' << '\n' <<
-
-                 "\\function_call:\n" <<
-                 messageInfo->function << '\n' << '\n' <<
-
-                 "\\category:\n" <<
-                 messageInfo->category << '\n' << '\n' <<
-
-                 "\\time_date:\n" <<
-                 messageInfo->dateTime.toString(Qt::ISODateWithMs) << '\n' << '\n';
-
-    switch (type)
-    {
-        case QtDebugMsg:
-            streamLog << "\\debug\\id" << messageInfo->id << ": \n" <<
-                         messageInfo->message + '\n';
-            streamLog << ">>>>>>>>>>>>>>>" << messageInfo->id << ">>>>>>>>>>>>>>>\n";
-
-            m_debug.append(messageInfo);
-            if((ulong)m_debug.size() > m_maximum_message_details_size)
-                m_debug.removeFirst();
-
-            if(!m_cb_debug->isChecked())
-                return;
-            break;
-
-        case QtInfoMsg:
-            streamLog << "\\info\\id" << messageInfo->id << ": \n" <<
-                         messageInfo->message + '\n';
-            streamLog << ">>>>>>>>>>>>>>>" << messageInfo->id << ">>>>>>>>>>>>>>>\n";
-
-            m_info.append(messageInfo);
-            if((ulong)m_info.size() > m_maximum_message_details_size)
-                m_info.removeFirst();
-
-            if(!m_cb_info->isChecked())
-                return;
-            break;
-
-        case QtWarningMsg:
-            streamLog << "\\warning\\id" << messageInfo->id << ": \n" <<
-                         messageInfo->message + '\n';
-            streamLog << ">>>>>>>>>>>>>>>" << messageInfo->id << ">>>>>>>>>>>>>>>\n";
-
-            m_warning.append(messageInfo);
-            if((ulong)m_warning.size() > m_maximum_message_details_size)
-                m_warning.removeFirst();
-
-            if(!m_cb_warning->isChecked())
-                return;
-            break;
-
-        case QtCriticalMsg:
-            streamLog << "\\critical\\id" << messageInfo->id << ": \n" <<
-                         messageInfo->message + '\n';
-            streamLog << ">>>>>>>>>>>>>>>" << messageInfo->id << ">>>>>>>>>>>>>>>\n";
-
-            m_critical.append(messageInfo);
-            if((ulong)m_critical.size() > m_maximum_message_details_size)
-                m_critical.removeFirst();
-
-            if(!m_cb_critical->isChecked())
-                return;
-            break;
-
-        case QtFatalMsg:
-
-            streamLog << "\\fatal\\id" << messageInfo->id << ": \n" <<
-                         messageInfo->message + '\n';
-            streamLog << ">>>>>>>>>>>>>>>" << messageInfo->id << ">>>>>>>>>>>>>>>\n";
-
-            streamLog.flush();
-
-            // emit the signal to create a dialog message box showing the fatal error message
-            Q_EMIT signal_fatal_message(msg);
-
-            // Waits for the message to be closed and the application terminated
-            QEventLoop loop;
-            loop.exec();
-
-            return;
-    }
-
-
-//    if(QThread::currentThread() == this->thread())
-//    {
-//        slot_create_message_item(messageInfo);
-//    }
-//    else
-//    {
-//        Q_EMIT signal_create_message_item(messageInfo);
-//    }
-
-    Q_EMIT signal_create_message_item(messageInfo);
+    const QString fileName = QtMessageFilterCore::followedLogFile();
+    this->setWindowTitle(fileName.isEmpty() ? QString("Qt Message Filter") :
+                                              QString("Qt Message Filter - %1").arg(fileName));
 }
 
 void QtMessageFilter::f_create_dialog_with_message_details(const MessageDetails& details)
@@ -431,19 +489,30 @@ void QtMessageFilter::f_create_dialog_with_message_details(const MessageDetails&
     m_current_dialog_text->setPlainText
             (
                 "Origin:\n" +
-                details.fileName + " " + QString::number(details.line) + '\n' + '\n' +
+                details.fileName() + " " + QString::number(details.line) + '\n' + '\n' +
 
                 "Function Call:\n" +
-                details.function + '\n' + '\n' +
+                details.function() + '\n' + '\n' +
 
                 "Category:\n" +
-                details.category + '\n' + '\n' +
+                details.category() + '\n' + '\n' +
+
+                "Thread:\n" +
+                details.threadName + " 0x" + QString::number(details.threadId, 16) + '\n' + '\n' +
 
                 "Time:\n" +
                 details.dateTime.toString(Qt::ISODateWithMs) + '\n' + '\n' +
 
+                (details.sampledOut > 0 ?
+                     "Sampled:\nkept 1 of " + QString::number(details.sampledOut + 1) + '\n' + '\n' :
+                     QString()) +
+
+                (!details.stack.isEmpty() ?
+                     "Stack:\n" + QtMessageFilterStackTrace::toText(details.stack) + '\n' + '\n' :
+                     QString()) +
+
                 typeStr + " message " + QString::number(details.id) + ":\n" +
-                details.message
+                QtMessageFilterCore::fullMessage(details)
 
              );
 
@@ -452,6 +521,17 @@ void QtMessageFilter::f_create_dialog_with_message_details(const MessageDetails&
 
 void QtMessageFilter::f_unset_message_of_type(const QtMsgType typeMssage)
 {
+    if(!m_rendering_enabled)
+        return;
+
+    // A template can have messages of several types and the search
+    //  already knows the types
+    if(m_cb_group_templates->isChecked() || !m_le_search->text().isEmpty())
+    {
+        f_materialize_items();
+        return;
+    }
+
     for(auto i = m_list.begin(); i!=m_list.end();  )
     {
         if(i->first->type == typeMssage)
@@ -466,100 +546,159 @@ void QtMessageFilter::f_unset_message_of_type(const QtMsgType typeMssage)
     }
 }
 
-
-void QtMessageFilter::f_set_message_of_type(const QtMsgType typeMessage)
+void QtMessageFilter::f_set_rendering_enabled(const bool enabled)
 {
-    // simplify this
-    QString styleSheet;
-    QList<QSharedPointer<MessageDetails>>* listOfMessageType = nullptr;
+    if(enabled == m_rendering_enabled)
+        return;
+    m_rendering_enabled = enabled;
 
-    switch(typeMessage)
+    if(m_rendering_enabled)
     {
-        case QtDebugMsg:
-        {
-            styleSheet = "QLabel { background-color : black; color : cyan; }";
-            listOfMessageType = &m_debug;
-        }break;
+        // Multi-thread support, &QtMessageFilter::slot_create_message_item will be
+        //  always executed on the main thread
+        m_connection_message_captured =
+                connect(QtMessageFilterCore::instance(), &QtMessageFilterCore::signal_message_captured,
+                        this, &QtMessageFilter::slot_create_message_item,
+                        Qt::QueuedConnection);
 
-        case QtInfoMsg:
-        {
-            styleSheet = "QLabel { background-color : black; color : #90ee90; }";
-            listOfMessageType = &m_info;
-        }break;
-        case QtWarningMsg:
-        {
-            styleSheet = "QLabel { background-color : black; color : yellow; }";
-            listOfMessageType = &m_warning;
-        }break;
-        case QtCriticalMsg:
-        {
-            styleSheet = "QLabel { background-color : black; color : red; }";
-            listOfMessageType = &m_critical;
-        }break;
+        f_materialize_items();
 
-        default:
-            return;
+        slot_update_statistics();
+        m_tmr_statistics->start();
     }
-
-    // Iterate from the last element (added more recently) to the first
-    for(auto i = listOfMessageType->end();
-        (ulong)m_vertical_layout_scroll_area->count() <= m_maximum_itens_size &&
-        i!=listOfMessageType->begin(); )
+    else
     {
-        --i;
-        QSharedPointer<MessageDetails> k = *i;
-        MessageItem* item = new MessageItem(m_widget_scroll_area);
-        item->setStyleSheet(styleSheet);
-        item->setText(k->message);
-        item->adjustSize();
+        // While hidden or minimized, the messages are only retained by
+        //  QtMessageFilterCore and no item exists
+        disconnect(m_connection_message_captured);
+        f_clear_items();
+        m_tmr_group_templates->stop();
+        m_tmr_search->stop();
+        m_search->cancel();
+        m_search_pending.clear();
+
+        m_tmr_statistics->stop();
+        QtMessageFilterCore::setLastRenderedId(-1);
+    }
+}
 
-        const ulong id = k->id;
+void QtMessageFilter::f_clear_items()
+{
+    for(auto i = m_list.begin(); i!=m_list.end(); ++i)
+        delete i->second;
+    m_list.clear();
+}
 
-        // Try to insert the new element on its right position, according with its id attribute
-        MessageItem* itemAfter = nullptr;
-        for(auto n = m_list.begin(); n!=m_list.end(); ++n)
-        {
-            if(n->first.get()->id > id)
-            {
-                itemAfter = n->second;
-                m_list.insert(n, QPair< QSharedPointer<MessageDetails>, MessageItem* >(k, item));
-                m_vertical_layout_scroll_area->insertWidget(m_vertical_layout_scroll_area->indexOf(itemAfter), item);
-                break;
-            }
-        }
-        if(!itemAfter)
-        {
-            m_vertical_layout_scroll_area->addWidget(item);
-            m_list.append(QPair< QSharedPointer<MessageDetails>, MessageItem* >(k, item));
-        }
+void QtMessageFilter::f_materialize_items()
+{
+    if(!m_rendering_enabled)
+        return;
 
-        item->show();
+    f_clear_items();
+    f_update_thread_filter();
+    m_tmr_group_templates->stop();
+    m_tmr_search->stop();
+    m_search->cancel();
+    m_search_pending.clear();
+
+    auto accept = [this](const MessageDetails& details){ return f_is_type_checked(details.type); };
+
+    if(!m_le_search->text().isEmpty())
+    {
+        // The items are created by QtMessageFilter::slot_search_results
+        f_start_search();
+    }
+    else if(m_cb_group_templates->isChecked())
+    {
+        // The groups are counted by QtMessageFilterCore as the messages are mined
+        f_materialize_groups();
+    }
+    else
+    {
+        // Only the last messages of the checked types would be visible
+        const QList<QSharedPointer<MessageDetails>> messages =
+                QtMessageFilterCore::lastMessages((int)m_maximum_itens_size, accept, m_thread_filter);
 
-        // Is this the best way of doing it?
-        connect(item, &MessageItem::SIGNAL_leftButtonReleased,
-                this, [this, k]{ f_create_dialog_with_message_details(*k); });
-        connect(item, &MessageItem::SIGNAL_rightButtonPressed,
-                this, [this, k, item]{ f_remove_item_from_list(k, item); });
+        for(const QSharedPointer<MessageDetails>& k : messages)
+            f_append_item(k);
     }
+
+    // Every message captured until now was considered
+    const QList<QSharedPointer<MessageDetails>> last = QtMessageFilterCore::lastMessages(1);
+    QtMessageFilterCore::setLastRenderedId(last.isEmpty() ? -1 : (qint64)last.first()->id);
+
+    // Show the last message once the layout is updated
+    QTimer::singleShot(0, this, [this]
+    {
+        if(m_scroll_area)
+            m_scroll_area->verticalScrollBar()->setValue(m_scroll_area->verticalScrollBar()->maximum());
+    });
 }
 
-void QtMessageFilter::f_remove_item_from_list(QSharedPointer<MessageDetails> messageDetails, MessageItem* item)
+void QtMessageFilter::f_start_search()
 {
-    if(messageDetails.get()->type == QtDebugMsg)
-        m_debug.removeOne(messageDetails);
-    else if(messageDetails.get()->type == QtInfoMsg)
-        m_info.removeOne(messageDetails);
-    else if(messageDetails.get()->type == QtWarningMsg)
-        m_warning.removeOne(messageDetails);
+    QtMessageFilterSearch::Query query;
+
+    query.types = 0;
+    for(const QtMsgType type : {QtDebugMsg, QtInfoMsg, QtWarningMsg, QtCriticalMsg})
+    {
+        if(f_is_type_checked(type))
+            query.types |= 1 << type;
+    }
+    query.threadId = m_thread_filter;
+
+    const QString text = m_le_search->text();
+    if(text.size() > 2 && text.startsWith('/') && text.endsWith('/'))
+    {
+        query.text = text.mid(1, text.size() - 2);
+        query.regularExpression = true;
+    }
     else
-        m_critical.removeOne(messageDetails);
+        query.text = text;
 
-    m_list.removeOne(QPair< QSharedPointer<MessageDetails>, MessageItem* >(messageDetails, item));
-    item->disconnect();
-    item->deleteLater();
+    m_search->search(query);
 }
 
-void QtMessageFilter::slot_create_message_item(QSharedPointer<MessageDetails> messageDetails)
+void QtMessageFilter::f_materialize_groups()
+{
+    int types = 0;
+    for(const QtMsgType type : {QtDebugMsg, QtInfoMsg, QtWarningMsg, QtCriticalMsg})
+    {
+        if(f_is_type_checked(type))
+            types |= 1 << type;
+    }
+
+    // Only the newest groups would be visible. The messages not mined yet
+    //  are shown once they are, on the next update of the groups
+    QList<QtMessageFilterCore::TemplateGroup> groups = QtMessageFilterCore::templateGroups(types, m_thread_filter);
+    std::sort(groups.begin(), groups.end(), [](const QtMessageFilterCore::TemplateGroup& a, const QtMessageFilterCore::TemplateGroup& b)
+    {
+        return a.last->id > b.last->id;
+    });
+    while((ulong)groups.size() > m_maximum_itens_size)
+        groups.removeLast();
+
+    for(int i = groups.size() - 1; i >= 0; i--)
+    {
+        const QtMessageFilterCore::TemplateGroup& group = groups.at(i);
+
+        // The messages with too many words have no template, an evicted
+        //  template has no text anymore, its last message is shown instead
+        MessageItem* item = f_append_item(group.last);
+        if(item && group.count > 1)
+        {
+            QString text = group.templateId >= 0 ? QtMessageFilterCore::templateText(group.templateId)
+                                                 : QString("messages without template");
+            if(text.isEmpty())
+                text = group.last->message();
+
+            item->setText(QString("(%1%2) %3").arg(QChar(0x00D7)).arg(group.count).arg(text));
+            item->adjustSize();
+        }
+    }
+}
+
+MessageItem* QtMessageFilter::f_append_item(QSharedPointer<MessageDetails> messageDetails)
 {
     QString styleSheet;
 
@@ -582,40 +721,171 @@ void QtMessageFilter::slot_create_message_item(QSharedPointer<MessageDetails> me
             styleSheet = "QLabel { background-color : black; color : red; }";
         }break;
         default:
-            return;
+            return nullptr;
     }
 
     MessageItem* item = new MessageItem(m_widget_scroll_area);
 
-    item->setText(messageDetails->message);
+    // Only the messages of the items are decoded
+    item->setText(messageDetails->message());
     item->setStyleSheet(styleSheet);
     m_list.append(QPair< QSharedPointer<MessageDetails>, MessageItem* >(messageDetails, item));
     m_vertical_layout_scroll_area->addWidget(item);
     item->show();
     item->adjustSize();
 
-    // Force update of the list of messages
-//    qApp->processEvents();
+    // Is this the best way of doing it?
+    connect(item, &MessageItem::SIGNAL_leftButtonReleased,
+            this, [this, messageDetails]{f_create_dialog_with_message_details(*messageDetails);});
+    connect(item, &MessageItem::SIGNAL_rightButtonPressed,
+            this, [this, messageDetails, item]{ f_remove_item_from_list(messageDetails, item); });
+
+    if((ulong)m_vertical_layout_scroll_area->count() > m_maximum_itens_size)
+    {
+        delete m_list.first().second;
+        m_list.removeFirst();
+    }
+
+    return item;
+}
+
+void QtMessageFilter::f_remove_item_from_list(QSharedPointer<MessageDetails> messageDetails, MessageItem* item)
+{
+    QtMessageFilterCore::removeMessage(messageDetails);
+
+    m_list.removeOne(QPair< QSharedPointer<MessageDetails>, MessageItem* >(messageDetails, item));
+    item->disconnect();
+    item->deleteLater();
+}
+
+void QtMessageFilter::f_update_thread_filter()
+{
+    const QList<QPair<quintptr, QString>> threads = QtMessageFilterCore::threads();
+
+    m_combo_thread->blockSignals(true);
+    m_combo_thread->clear();
+    m_combo_thread->addItem("All threads", QVariant((qulonglong)0));
+    for(const QPair<quintptr, QString>& k : threads)
+    {
+        m_known_threads.insert(k.first);
+        m_combo_thread->addItem(k.second + " (0x" + QString::number(k.first, 16) + ")", QVariant((qulonglong)k.first));
+    }
+
+    // The thread chosen continues selected, even without retained messages
+    int index = m_combo_thread->findData(QVariant((qulonglong)m_thread_filter));
+    if(index < 0)
+    {
+        m_combo_thread->addItem("0x" + QString::number(m_thread_filter, 16), QVariant((qulonglong)m_thread_filter));
+        index = m_combo_thread->count() - 1;
+    }
+    m_combo_thread->setCurrentIndex(index);
+    m_combo_thread->blockSignals(false);
+}
+
+bool QtMessageFilter::f_is_type_checked(const QtMsgType typeMessage) const
+{
+    switch(typeMessage)
+    {
+        case QtDebugMsg:
+            return m_cb_debug->isChecked();
+        case QtInfoMsg:
+            return m_cb_info->isChecked();
+        case QtWarningMsg:
+            return m_cb_warning->isChecked();
+        case QtCriticalMsg:
+            return m_cb_critical->isChecked();
+        default:
+            return false;
+    }
+}
+
+void QtMessageFilter::slot_create_message_item(QSharedPointer<MessageDetails> messageDetails)
+{
+    // Events queued before the dialog was hidden
+    if(!m_rendering_enabled)
+        return;
+
+    QtMessageFilterCore::setLastRenderedId(messageDetails->id);
+
+    if(!m_known_threads.contains(messageDetails->threadId))
+        f_update_thread_filter();
+
+    if(!f_is_type_checked(messageDetails->type))
+        return;
+
+    if(m_thread_filter && messageDetails->threadId != m_thread_filter)
+        return;
+
+    if(!m_le_search->text().isEmpty())
+    {
+        // It is already on the results of the search
+        if((qint64)messageDetails->id <= m_search->lastSearchedId())
+            return;
+
+        // Only after the results of the search, that are older
+        if(m_search->isRunning())
+        {
+            m_search_pending.append(messageDetails);
+            return;
+        }
+
+        if(!m_search->matches(*messageDetails))
+            return;
+    }
+    // The groups are created again a little later, when the template of
+    //  the message is already known
+    else if(m_cb_group_templates->isChecked())
+    {
+        if(!m_tmr_group_templates->isActive())
+            m_tmr_group_templates->start();
+        return;
+    }
 
     // If the item further below is visible, make sure the new item continues visible as well
     const bool lockDownertical = m_scroll_area->verticalScrollBar()->maximum() - m_scroll_area->verticalScrollBar()->value() < 50;
 
+    f_append_item(messageDetails);
+
     if(lockDownertical)
     {
         m_scroll_area->verticalScrollBar()->setValue(m_scroll_area->verticalScrollBar()->maximum());
     }
+}
 
-    // Is this the best way of doing it?
-    connect(item, &MessageItem::SIGNAL_leftButtonReleased,
-            this, [this, messageDetails]{f_create_dialog_with_message_details(*messageDetails);});
-    connect(item, &MessageItem::SIGNAL_rightButtonPressed,
-            this, [this, messageDetails, item]{ f_remove_item_from_list(messageDetails, item); });
+void QtMessageFilter::slot_search_results(QList<QSharedPointer<MessageDetails>> results)
+{
+    if(!m_rendering_enabled)
+        return;
 
-    if((ulong)m_vertical_layout_scroll_area->count() > m_maximum_itens_size)
+    const bool lockDownVertical = m_scroll_area->verticalScrollBar()->maximum() - m_scroll_area->verticalScrollBar()->value() < 50;
+
+    // The results arrive on the order of the ids, only the last ones would be visible
+    for(int i = qMax(0, results.size() - (int)m_maximum_itens_size); i < results.size(); i++)
+        f_append_item(results.at(i));
+
+    if(lockDownVertical)
     {
-        delete m_list.first().second;
-        m_list.removeFirst();
+        QTimer::singleShot(0, this, [this]
+        {
+            m_scroll_area->verticalScrollBar()->setValue(m_scroll_area->verticalScrollBar()->maximum());
+        });
+    }
+}
+
+void QtMessageFilter::slot_search_finished()
+{
+    const QList<QSharedPointer<MessageDetails>> pending = m_search_pending;
+    m_search_pending.clear();
+
+    QList<QSharedPointer<MessageDetails>> results;
+    for(const QSharedPointer<MessageDetails>& k : pending)
+    {
+        if(m_search->matches(*k))
+            results.append(k);
     }
+
+    if(!results.isEmpty())
+        slot_search_results(results);
 }
 
 void QtMessageFilter::slot_fatal_message(const QString &msg)
@@ -630,6 +900,196 @@ void QtMessageFilter::slot_fatal_message(const QString &msg)
     qApp->exit(1);
 }
 
+void QtMessageFilter::slot_update_statistics()
+{
+    m_label_statistics->setText(f_statistics_text(QtMessageFilterCore::statistics()));
+}
+
+QString QtMessageFilter::f_statistics_text(const QtMessageFilterCore::Statistics& statistics)
+{
+    double messagesPerSecond = 0;
+    for(const double k : statistics.messagesPerSecond)
+        messagesPerSecond += k;
+
+    quint64 dropped = 0;
+    for(const quint64 k : statistics.writer.dropped)
+        dropped += k;
+
+    // Upper limit of the bucket of the 99th percentile
+    quint64 flushes = 0;
+    for(const quint64 k : statistics.writer.flushLatency)
+        flushes += k;
+
+    QString flushLatency = "-";
+    quint64 accumulated = 0;
+    for(int i = 0; i < QtMessageFilterLogWriter::FlushLatencyBuckets && flushes > 0; i++)
+    {
+        accumulated += statistics.writer.flushLatency[i];
+        if(accumulated*100 >= flushes*99)
+        {
+            flushLatency = i == QtMessageFilterLogWriter::FlushLatencyBuckets - 1 ?
+                        QString(">= %1 ms").arg((1ull << i)/1000) :
+                        QString("< %1 us").arg(2ull << i);
+            break;
+        }
+    }
+
+    return QString("%1 msg/s (D %2, I %3, W %4, C %5) | %6 MiB written | queue %7/%8 | "
+                   "%9 dropped | flush p99 %10 | UI lag %11")
+            .arg(messagesPerSecond, 0, 'f', 1)
+            .arg(statistics.messagesPerSecond[QtDebugMsg], 0, 'f', 1)
+            .arg(statistics.messagesPerSecond[QtInfoMsg], 0, 'f', 1)
+            .arg(statistics.messagesPerSecond[QtWarningMsg], 0, 'f', 1)
+            .arg(statistics.messagesPerSecond[QtCriticalMsg], 0, 'f', 1)
+            .arg(statistics.writer.bytesWritten/(1024.0*1024.0), 0, 'f', 1)
+            .arg(statistics.writer.queueDepth)
+            .arg(statistics.writer.queueCapacity)
+            .arg(dropped)
+            .arg(flushLatency)
+            .arg(statistics.renderLag < 0 ? QString("-") : QString::number(statistics.renderLag));
+}
+
+void QtMessageFilter::f_show_top_talkers()
+{
+    if(!m_top_talkers_dialog)
+    {
+        m_top_talkers_dialog = new QDialog(this);
+        m_top_talkers_table = new QTableWidget(0, 7, m_top_talkers_dialog);
+        m_tmr_top_talkers = new QTimer(m_top_talkers_dialog);
+
+        QVBoxLayout* verticalLayout = new QVBoxLayout(m_top_talkers_dialog);
+        QHBoxLayout* horizontalLayout = new QHBoxLayout();
+        QPushButton* pbSilence = new QPushButton("Silence/unsilence location", m_top_talkers_dialog);
+        QPushButton* pbExport = new QPushButton("Export CSV...", m_top_talkers_dialog);
+
+        m_top_talkers_table->setHorizontalHeaderLabels({"File", "Line", "Function", "Count", "Bytes", "Rate (/s)", "Silenced"});
+        m_top_talkers_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        m_top_talkers_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+        m_top_talkers_table->verticalHeader()->hide();
+        m_top_talkers_table->horizontalHeader()->setStretchLastSection(true);
+        m_top_talkers_table->setSortingEnabled(true);
+        m_top_talkers_table->sortByColumn(3, Qt::DescendingOrder);
+
+        horizontalLayout->addWidget(pbSilence);
+        horizontalLayout->addStretch();
+        horizontalLayout->addWidget(pbExport);
+        verticalLayout->addWidget(m_top_talkers_table);
+        verticalLayout->addLayout(horizontalLayout);
+
+        connect(pbSilence, &QPushButton::clicked,
+                this, &QtMessageFilter::f_silence_selected_locations);
+        connect(pbExport, &QPushButton::clicked,
+                this, &QtMessageFilter::f_export_top_talkers);
+        connect(m_tmr_top_talkers, &QTimer::timeout,
+                this, &QtMessageFilter::slot_update_top_talkers);
+
+        m_top_talkers_dialog->setWindowTitle("Top talkers");
+        m_top_talkers_dialog->resize(800, 400);
+    }
+
+    m_top_talkers_dialog->show();
+    slot_update_top_talkers();
+    m_tmr_top_talkers->start(1000);
+}
+
+void QtMessageFilter::f_silence_selected_locations()
+{
+    for(const QModelIndex& k : m_top_talkers_table->selectionModel()->selectedRows())
+    {
+        const int row = k.row();
+        QtMessageFilterCore::setLocationSilenced(m_top_talkers_table->item(row, 0)->text(),
+                                                 m_top_talkers_table->item(row, 1)->data(Qt::DisplayRole).toInt(),
+                                                 m_top_talkers_table->item(row, 2)->text(),
+                                                 m_top_talkers_table->item(row, 6)->text().isEmpty());
+    }
+
+    slot_update_top_talkers();
+}
+
+void QtMessageFilter::f_export_top_talkers()
+{
+    const QString fileName = QFileDialog::getSaveFileName(m_top_talkers_dialog, "Export top talkers",
+                                                          "QtMessageFilterTopTalkers.csv", "CSV (*.csv)");
+    if(fileName.isEmpty())
+        return;
+
+    if(!QtMessageFilterCore::exportLocations(fileName))
+        QMessageBox::warning(m_top_talkers_dialog, "QtMessageFilter", QString("Could not write the file %1.").arg(fileName));
+}
+
+void QtMessageFilter::f_follow_log_file()
+{
+    const QString fileName = QFileDialog::getOpenFileName(this, "Follow log file",
+                                                          QtMessageFilterCore::followedLogFile(),
+                                                          "Log files (*.txt *.log);;All files (*)");
+    if(fileName.isEmpty())
+        return;
+
+    QtMessageFilter::followLogFile(fileName);
+}
+
+void QtMessageFilter::slot_update_top_talkers()
+{
+    // The counters are only read while the table is visible
+    if(!m_top_talkers_dialog->isVisible())
+    {
+        m_tmr_top_talkers->stop();
+        return;
+    }
+
+    auto locationKey = [](const QString& fileName, const int line, const QString& function)
+    {
+        return fileName + ':' + QString::number(line) + ':' + function;
+    };
+
+    // The selected locations continue selected after the update
+    QSet<QString> selected;
+    for(const QModelIndex& k : m_top_talkers_table->selectionModel()->selectedRows())
+    {
+        selected.insert(locationKey(m_top_talkers_table->item(k.row(), 0)->text(),
+                                    m_top_talkers_table->item(k.row(), 1)->data(Qt::DisplayRole).toInt(),
+                                    m_top_talkers_table->item(k.row(), 2)->text()));
+    }
+
+    const QList<QtMessageFilterCore::Location> locations = QtMessageFilterCore::locations();
+
+    auto newItem = [](const QVariant& value)
+    {
+        QTableWidgetItem* item = new QTableWidgetItem();
+        item->setData(Qt::DisplayRole, value);
+        return item;
+    };
+
+    // The rows are sorted again, by the column chosen, once they are all set
+    m_top_talkers_table->setSortingEnabled(false);
+    m_top_talkers_table->clearSelection();
+    m_top_talkers_table->setRowCount(locations.size());
+    for(int row = 0; row < locations.size(); row++)
+    {
+        const QtMessageFilterCore::Location& k = locations.at(row);
+
+        m_top_talkers_table->setItem(row, 0, newItem(k.fileName));
+        m_top_talkers_table->setItem(row, 1, newItem(k.line));
+        m_top_talkers_table->setItem(row, 2, newItem(k.function));
+        m_top_talkers_table->setItem(row, 3, newItem((qulonglong)k.count));
+        m_top_talkers_table->setItem(row, 4, newItem((qulonglong)k.bytes));
+        m_top_talkers_table->setItem(row, 5, newItem(qRound(k.rate*10)/10.0));
+        m_top_talkers_table->setItem(row, 6, newItem(k.silenced ? QString("yes") : QString()));
+    }
+    m_top_talkers_table->setSortingEnabled(true);
+
+    for(int row = 0; row < m_top_talkers_table->rowCount() && !selected.isEmpty(); row++)
+    {
+        if(selected.contains(locationKey(m_top_talkers_table->item(row, 0)->text(),
+                                         m_top_talkers_table->item(row, 1)->data(Qt::DisplayRole).toInt(),
+                                         m_top_talkers_table->item(row, 2)->text())))
+        {
+            m_top_talkers_table->selectionModel()->select(m_top_talkers_table->model()->index(row, 0),
+                                                          QItemSelectionModel::Select | QItemSelectionModel::Rows);
+        }
+    }
+}
+
 
 MessageItem::MessageItem(QWidget* parent):
     QLabel(parent),
@@ -682,25 +1142,3 @@ void MessageItem::mouseReleaseEvent(QMouseEvent* e)
         }
     }
 }
-
-MessageDetails::MessageDetails(const QtMsgType thatType,
-                               const QMessageLogContext& thatContext,
-                               const QString& thatMessage,
-                               const ulong thatId,
-                               const QDateTime thatDateTime) :
-    type(thatType),
-    line(thatContext.line),
-    fileName(thatContext.file),
-    function(thatContext.function),
-    category(thatContext.category),
-    message(thatMessage),
-    id(thatId),
-    dateTime(thatDateTime)
-{
-
-}
-
-MessageDetails::~MessageDetails()
-{
-
-}
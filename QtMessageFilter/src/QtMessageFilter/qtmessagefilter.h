@@ -32,41 +32,17 @@
 #include <QDialog>
 #include <QPlainTextEdit>
 #include <QCheckBox>
+#include <QComboBox>
+#include <QSet>
 #include <QDateTime>
 #include <QSpacerItem>
+#include <QTimer>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QLineEdit>
 
-
-///
-/// \brief This struct contains all information of a log message
-/// \details It is very similar to [QMessageLogContext](https://doc.qt.io/qt-5/qmessagelogcontext.html),
-/// but it has some additional information (the id of the message for the class
-/// QtMessageFilter and the time of generation of the message). The id of the message
-/// is count of messages when the message was generated, that way, the first message will
-/// have id=0, the seconde one will have id=1 and so on.
-/// It also hold not just the context of the message but the message itself.
-///
-struct MessageDetails
-{
-    const QtMsgType type;
-    const int line;
-
-    const QString fileName;
-    const QString function;
-    const QString category;
-
-    const QString message;
-
-    const ulong id;
-    const QDateTime dateTime;
-
-    MessageDetails(const QtMsgType thatType,
-                   const QMessageLogContext& thatContext,
-                   const QString& thatMessage,
-                   const ulong thatId,
-                   const QDateTime thatDateTime);
-
-    ~MessageDetails();
-};
+#include "qtmessagefiltercore.h"
+#include "qtmessagefiltersearch.h"
 
 
 ///
@@ -77,7 +53,7 @@ struct MessageDetails
 /// blue until the user realese the button, then a dialog appear with
 /// all informations of the message. But if the user keep pressing it
 /// for 0.5s, then the message will be copied to the clipboard. This
-/// behaviour is defined on QtMessageFilter::f_message_output, on the
+/// behaviour is defined on QtMessageFilter::slot_create_message_item, on the
 /// creation of the item. Also, if the user presses the item with the
 /// right button of the mouse, the item will be deleted.
 ///
@@ -100,14 +76,15 @@ Q_SIGNALS:
     void SIGNAL_leftButtonReleased();
     void SIGNAL_rightButtonPressed();
 };
-Q_DECLARE_METATYPE(QSharedPointer<MessageDetails>)
+
 
 ///
 /// \brief This class is responsible for treat the messages of the application
 /// \details It is a Singleton class, because there must be only one instance
 /// of this class. It can be initialed calling the function
 /// QtMessageFilter::resetInstance(), with the option to choose the parent
-/// widget. When it is initialed, it install the message handler of the class.
+/// widget. When it is initialed, it initializes QtMessageFilterCore, which
+/// installs the message handler, and connects to it.
 /// It is generated a new User Interface showing a list all the messages
 /// that are generated on the execution of the application.
 ///
@@ -126,17 +103,59 @@ Q_DECLARE_METATYPE(QSharedPointer<MessageDetails>)
 /// represents debug messages, the 'i' icon inside a green circle represents
 /// information messages, the '!' inside a yellow triangle represents warning
 /// messages and the 'x' inside a red circle represents critical messages.
+/// The combo box on the right shows only the messages of one thread.
+///
+/// The button "Top talkers" opens a table with the locations of the code (file,
+/// line and function) that generated more messages, with their count, bytes and
+/// rate, updated each second and sortable by any column. The selected locations
+/// can be silenced (their messages are discarded by QtMessageFilterCore) and the
+/// table can be exported as CSV.
+///
+/// The checkbox "Group" collapses the messages with the same template (see
+/// QtMessageFilterCore::templateText()) on a single item, with the count of
+/// messages retained and the template, like "(x42) Teste <*>". The details of an
+/// item are the ones of the last message of its template. Since the templates are
+/// mined on the thread of the log file, the groups are updated a little later than
+/// the messages arrive.
+///
+/// The field "Search" shows only the messages that contain its text (ignoring the
+/// case), or that match a regular expression written between slashes, like
+/// "/Teste [0-9]+$/". The retained messages are searched in parallel by
+/// QtMessageFilterSearch and the items appear as the results arrive, a new text
+/// cancels the last search. While searching, the messages are not grouped.
+///
+/// The button "Follow..." (or QtMessageFilter::followLogFile()) follows the log file
+/// of another process, like "tail -f": the messages it writes are shown as the ones of
+/// this application, with the same filters and search, and only the new bytes of the
+/// file are read on each change (see QtMessageFilterLogFollower).
+///
+/// The strip on the bottom shows, each second, how QtMessageFilterCore is coping
+/// (see QtMessageFilterCore::statistics()): messages per second, bytes written on
+/// the log file, depth of its queue, dropped messages, the 99th percentile of the
+/// latency of its flushes and how many messages the dialog has not rendered yet.
 ///
 /// It is possible to show and hide the User Interface calling the functions
 /// QtMessageFilter::hideDialog and
 /// QtMessageFilter::showDialog.
 ///
+/// The widgets of the dialog are only created the first time it is shown, so a filter
+/// initialized hidden costs nothing besides QtMessageFilterCore. While the dialog is
+/// hidden or minimized, it does not receive the messages and keeps no item, when it
+/// is shown again the items of the last messages are created from QtMessageFilterCore.
+///
+/// The messages are retained by QtMessageFilterCore on a budget of bytes, the
+/// parameters maximumRetainedBytes and maximumMessageBytes of
+/// QtMessageFilter::resetInstance(). maximumMessageDetailsSize, the count of messages
+/// of each type retained by older versions, is still accepted but no longer used.
+///
 /// Note that this class will be operating even when it is hidden. To delete the instance
 /// of the class and disable the message filter, call QtMessageFilter::releaseInstance().
 ///
 /// One last recurse of this class is a log file that is generated containing all the
 /// messages -- with its informations -- of the last session. Note that the log file
-/// always overwrite the one of the last file, so save a copy if needed.
+/// always overwrite the one of the last file, so save a copy if needed. The log file
+/// is written by QtMessageFilterCore, which can also be used alone on applications
+/// without QtWidgets.
 ///
 class QtMessageFilter : public QDialog
 {
@@ -144,7 +163,9 @@ class QtMessageFilter : public QDialog
 
 public:
 
-    static void resetInstance(QWidget* parent = nullptr, bool hideDialog = false, const ulong maximumItensSize = 100, const ulong maximumMessageDetailsSize = 10);
+    static void resetInstance(QWidget* parent = nullptr, bool hideDialog = false, const ulong maximumItensSize = 100,
+                              const ulong maximumMessageDetailsSize = 10,
+                              const ulong maximumRetainedBytes = 16*1024*1024, const ulong maximumMessageBytes = 64*1024);
     static void releaseInstance();
     static bool good();
 
@@ -153,17 +174,21 @@ public:
     static void showDialog();
     static bool isDialogVisible();
     static void setInstanceParent(QWidget* parent);
+    static void setMessageTypeVisible(const QtMsgType type, const bool visible);
+    static void followLogFile(const QString& fileName);
 
 protected:
 
     void closeEvent(QCloseEvent *event = nullptr);
     void hideEvent(QHideEvent* event = nullptr);
+    void showEvent(QShowEvent* event = nullptr);
+    void changeEvent(QEvent* event = nullptr);
     void reject();
 
 
 private:
 
-    QtMessageFilter(QWidget *parent = nullptr, const ulong maximumItensSize = 100, const ulong maximumMessageDetailsSize = 10);
+    QtMessageFilter(QWidget *parent = nullptr, const ulong maximumItensSize = 100);
     QtMessageFilter(const QtMessageFilter& that) = delete;
     QtMessageFilter(QtMessageFilter&& that) = delete;
     ~QtMessageFilter();
@@ -173,32 +198,41 @@ private:
 
     void f_configure_ui();
 
-    static void f_message_filter(const QtMsgType type,
-                                 const QMessageLogContext& context,
-                                 const QString& msg);
-
-    void f_message_output(const QtMsgType type,
-                          const QMessageLogContext& context,
-                          const QString& msg);
-
     void f_create_dialog_with_message_details(const MessageDetails& details);
 
     void f_unset_message_of_type(const QtMsgType typeMessage);
-    void f_set_message_of_type(const QtMsgType typeMessage);
+
+    void f_set_rendering_enabled(const bool enabled);
+    void f_clear_items();
+    void f_materialize_items();
+    void f_start_search();
+    void f_materialize_groups();
+    MessageItem* f_append_item(QSharedPointer<MessageDetails> messageDetails);
 
     void f_remove_item_from_list(QSharedPointer<MessageDetails> messageDetails, MessageItem* item);
 
-    QList<QSharedPointer<MessageDetails>> m_debug;
-    QList<QSharedPointer<MessageDetails>> m_info;
-    QList<QSharedPointer<MessageDetails>> m_warning;
-    QList<QSharedPointer<MessageDetails>> m_critical;
+    bool f_is_type_checked(const QtMsgType typeMessage) const;
+
+    void f_update_thread_filter();
+    void f_update_window_title();
 
-    ulong m_last_id;
+    static QString f_statistics_text(const QtMessageFilterCore::Statistics& statistics);
+
+    void f_show_top_talkers();
+    void f_silence_selected_locations();
+    void f_export_top_talkers();
+    void f_follow_log_file();
 
     QList<  QPair< QSharedPointer<MessageDetails>, MessageItem* >  > m_list;
 
+    // Items only exist and messages are only received while the
+    //  dialog is visible and not minimized
+    bool m_rendering_enabled;
+    QMetaObject::Connection m_connection_message_captured;
+
 
     // UI
+    bool m_ui_configured;
     QVBoxLayout* m_vertical_layout_global;
 
     QScrollArea* m_scroll_area;
@@ -211,6 +245,36 @@ private:
     QCheckBox* m_cb_info;
     QCheckBox* m_cb_warning;
     QCheckBox* m_cb_critical;
+
+    // Thread of the messages shown, 0 shows all threads
+    QComboBox* m_combo_thread;
+    quintptr m_thread_filter;
+    QSet<quintptr> m_known_threads;
+
+    // Messages grouped by template, the groups are created again at most
+    //  once in each interval of the timer
+    QCheckBox* m_cb_group_templates;
+    QTimer* m_tmr_group_templates;
+
+    // Search on the retained messages, started a little after the text is edited.
+    //  The messages captured while it runs are only shown when it finishes
+    QLineEdit* m_le_search;
+    QTimer* m_tmr_search;
+    QtMessageFilterSearch* m_search;
+    QList<QSharedPointer<MessageDetails>> m_search_pending;
+
+    // Status strip, updated while the items are rendered
+    QLabel* m_label_statistics;
+    QTimer* m_tmr_statistics;
+
+    // Top talkers, the dialog is created the first time it is shown
+    QPushButton* m_pb_top_talkers;
+    QDialog* m_top_talkers_dialog;
+    QTableWidget* m_top_talkers_table;
+    QTimer* m_tmr_top_talkers;
+
+    // Follows the log file of another process (see QtMessageFilterCore::followLogFile())
+    QPushButton* m_pb_follow;
     // UI
 
 
@@ -221,18 +285,14 @@ private:
     // Dialog With message info
 
 
-    QScopedPointer<QFile> m_log_file;
-
-
     const ulong m_maximum_itens_size;
-    const ulong m_maximum_message_details_size;
 
 private Q_SLOTS:
     void slot_create_message_item(QSharedPointer<MessageDetails> messageDetails);
     void slot_fatal_message(const QString& msg);
-
-Q_SIGNALS:
-    void signal_create_message_item(QSharedPointer<MessageDetails> messageDetails);
-    void signal_fatal_message(const QString& msg);
+    void slot_update_statistics();
+    void slot_update_top_talkers();
+    void slot_search_results(QList<QSharedPointer<MessageDetails>> results);
+    void slot_search_finished();
 };
 #endif // MESSAGEFILTERQT_H
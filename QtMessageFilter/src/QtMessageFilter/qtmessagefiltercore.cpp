@@ -0,0 +1,1274 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "qtmessagefiltercore.h"
+
+#include <QDebug>
+#include <QEventLoop>
+#include <QMetaMethod>
+#include <QThread>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+
+#include <cstdio>
+#include <algorithm>
+
+QtMessageFilterCore* QtMessageFilterCore::m_singleton_instance = nullptr;
+
+// Set while a thread is inside the message handler, a message generated
+//  by the handler itself (e.g. a warning of QFile) is then sent to stderr
+//  instead of dead locking on m_mutex
+static thread_local bool t_inside_message_handler = false;
+
+// Identity of the thread, looked up only on its first message
+struct ThreadIdentity
+{
+    quintptr id;
+    QString name;
+    QByteArray nameUtf8;
+};
+
+static const ThreadIdentity& f_current_thread_identity()
+{
+    static thread_local ThreadIdentity identity{0, QString(), QByteArray()};
+
+    if(!identity.id)
+    {
+        identity.id = (quintptr)QThread::currentThreadId();
+
+        QThread* thread = QThread::currentThread();
+        identity.name = thread->objectName();
+        if(identity.name.isEmpty())
+        {
+            if(QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+                identity.name = "main";
+            else
+                identity.name = "0x" + QString::number(identity.id, 16);
+        }
+        identity.nameUtf8 = identity.name.toUtf8();
+    }
+
+    return identity;
+}
+
+void QtMessageFilterCore::resetInstance(const ulong maximumRetainedBytes, const ulong maximumMessageBytes)
+{
+    delete QtMessageFilterCore::m_singleton_instance;
+    QtMessageFilterCore::m_singleton_instance = new QtMessageFilterCore(maximumRetainedBytes, maximumMessageBytes);
+
+    // Install the message handler of this class, the one replaced is installed again on release
+    QtMessageFilterCore::m_singleton_instance->m_previous_message_handler =
+            qInstallMessageHandler(QtMessageFilterCore::f_message_filter);
+}
+
+void QtMessageFilterCore::releaseInstance()
+{
+    if(!QtMessageFilterCore::good())
+        return;
+
+    delete QtMessageFilterCore::m_singleton_instance;
+    QtMessageFilterCore::m_singleton_instance = nullptr;
+}
+
+bool QtMessageFilterCore::good()
+{
+    return (bool)QtMessageFilterCore::m_singleton_instance;
+}
+
+QtMessageFilterCore* QtMessageFilterCore::instance()
+{
+    return QtMessageFilterCore::m_singleton_instance;
+}
+
+QList<QSharedPointer<MessageDetails>> QtMessageFilterCore::messagesOfType(const QtMsgType type)
+{
+    if(!QtMessageFilterCore::good())
+    {
+        qWarning()<<"You tried to call a method of the class QtMessageFilterCore when it was inactive,"
+                    " please call QtMessageFilterCore::resetInstance before use any method of this class.\n"
+                    "Thanks.";
+        return QList<QSharedPointer<MessageDetails>>();
+    }
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    QMutexLocker locker(&core->m_mutex);
+
+    QList<QSharedPointer<MessageDetails>> list;
+    for(const QSharedPointer<MessageDetails>& k : qAsConst(core->m_messages))
+    {
+        if(k->type == type)
+            list.append(k);
+    }
+    return list;
+}
+
+QList<QSharedPointer<MessageDetails>> QtMessageFilterCore::lastMessages(const int count,
+                                                                        std::function<bool(const MessageDetails&)> accept,
+                                                                        const quintptr threadId)
+{
+    if(!QtMessageFilterCore::good())
+        return QList<QSharedPointer<MessageDetails>>();
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    QMutexLocker locker(&core->m_mutex);
+
+    // Only the lane of the thread is read when one is chosen
+    auto lane = core->m_thread_lanes.constFind(threadId);
+    if(threadId && lane == core->m_thread_lanes.constEnd())
+        return QList<QSharedPointer<MessageDetails>>();
+
+    const QList<QSharedPointer<MessageDetails>>& messages = threadId ? lane.value() : core->m_messages;
+
+    // Iterate from the last element (added more recently) to the first
+    QList<QSharedPointer<MessageDetails>> list;
+    for(auto i = messages.constEnd(); list.size() < count && i != messages.constBegin(); )
+    {
+        --i;
+        if(!accept || accept(**i))
+            list.prepend(*i);
+    }
+    return list;
+}
+
+bool QtMessageFilterCore::retainedIds(ulong* firstId, ulong* lastId)
+{
+    if(!QtMessageFilterCore::good())
+        return false;
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    QMutexLocker locker(&core->m_mutex);
+
+    if(core->m_messages.isEmpty())
+        return false;
+
+    if(firstId)
+        *firstId = core->m_messages.first()->id;
+    if(lastId)
+        *lastId = core->m_messages.last()->id;
+    return true;
+}
+
+QList<QSharedPointer<MessageDetails>> QtMessageFilterCore::messagesInRange(const ulong fromId, const ulong toId,
+                                                                           const quintptr threadId)
+{
+    if(!QtMessageFilterCore::good())
+        return QList<QSharedPointer<MessageDetails>>();
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    QMutexLocker locker(&core->m_mutex);
+
+    auto lane = core->m_thread_lanes.constFind(threadId);
+    if(threadId && lane == core->m_thread_lanes.constEnd())
+        return QList<QSharedPointer<MessageDetails>>();
+
+    const QList<QSharedPointer<MessageDetails>>& messages = threadId ? lane.value() : core->m_messages;
+
+    // The messages (and each lane) are on the order of their ids
+    auto byId = [](const QSharedPointer<MessageDetails>& details, const ulong id){ return details->id < id; };
+    auto begin = std::lower_bound(messages.constBegin(), messages.constEnd(), fromId, byId);
+    auto end = std::lower_bound(begin, messages.constEnd(), toId, byId);
+
+    QList<QSharedPointer<MessageDetails>> list;
+    list.reserve((int)(end - begin));
+    for(auto i = begin; i != end; ++i)
+        list.append(*i);
+    return list;
+}
+
+QList<QPair<quintptr, QString>> QtMessageFilterCore::threads()
+{
+    if(!QtMessageFilterCore::good())
+        return QList<QPair<quintptr, QString>>();
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    QMutexLocker locker(&core->m_mutex);
+
+    QList<QPair<quintptr, QString>> list;
+    for(auto i = core->m_thread_lanes.constBegin(); i != core->m_thread_lanes.constEnd(); ++i)
+        list.append(QPair<quintptr, QString>(i.key(), i.value().first()->threadName));
+    return list;
+}
+
+void QtMessageFilterCore::removeMessage(QSharedPointer<MessageDetails> messageDetails)
+{
+    if(!QtMessageFilterCore::good() || !messageDetails)
+        return;
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    QMutexLocker locker(&core->m_mutex);
+
+    if(core->m_messages.removeOne(messageDetails))
+    {
+        core->m_retained_total -= messageDetails->bytes;
+        core->m_retained_bytes.storeRelease(core->m_retained_total);
+        core->f_remove_from_thread_lane(messageDetails, false);
+        core->f_ungroup(messageDetails);
+        core->f_release_spill(*messageDetails);
+    }
+}
+
+QString QtMessageFilterCore::fullMessage(const MessageDetails& details)
+{
+    if(!details.isTruncated() || !QtMessageFilterCore::good())
+        return details.message();
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    QMutexLocker locker(&core->m_spill_mutex);
+
+    // Discarded by a compaction of the spill file, after the message was released
+    if(details.spillOffset < core->m_spill_base || !core->m_spill_file.seek(details.spillOffset - core->m_spill_base))
+        return details.message();
+
+    return QString::fromUtf8(core->m_spill_file.read(details.spillSize));
+}
+
+qint64 QtMessageFilterCore::retainedBytes()
+{
+    if(!QtMessageFilterCore::good())
+        return 0;
+
+    return QtMessageFilterCore::m_singleton_instance->m_retained_bytes.loadAcquire();
+}
+
+void QtMessageFilterCore::flush()
+{
+    if(!QtMessageFilterCore::good())
+        return;
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+
+    // The messages dropped by the sampling after the last one kept of their location
+    const QByteArray sampledOut = core->f_sampled_out_record();
+    if(!sampledOut.isEmpty())
+        core->m_log_writer->write(sampledOut, QtInfoMsg);
+
+    // Blocks until the messages generated before are on the log file
+    core->m_log_writer->flush();
+}
+
+void QtMessageFilterCore::setOverloadPolicy(const QtMsgType type, const OverloadPolicy policy, const int timeout)
+{
+    if(!QtMessageFilterCore::good())
+    {
+        qWarning()<<"You tried to call a method of the class QtMessageFilterCore when it was inactive,"
+                    " please call QtMessageFilterCore::resetInstance before use any method of this class.\n"
+                    "Thanks.";
+        return;
+    }
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    QMutexLocker locker(&core->m_mutex);
+
+    core->m_overload_of_type[type] = OverloadSettings{policy, timeout};
+}
+
+void QtMessageFilterCore::setCategoryOverloadPolicy(const QString& category, const OverloadPolicy policy, const int timeout)
+{
+    if(!QtMessageFilterCore::good())
+    {
+        qWarning()<<"You tried to call a method of the class QtMessageFilterCore when it was inactive,"
+                    " please call QtMessageFilterCore::resetInstance before use any method of this class.\n"
+                    "Thanks.";
+        return;
+    }
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    QMutexLocker locker(&core->m_mutex);
+
+    core->m_overload_of_category.insert(category.toUtf8(), OverloadSettings{policy, timeout});
+}
+
+void QtMessageFilterCore::setWriterQueueCapacity(const int capacity)
+{
+    if(QtMessageFilterCore::good())
+        QtMessageFilterCore::m_singleton_instance->m_log_writer->setCapacity(capacity);
+}
+
+quint64 QtMessageFilterCore::droppedMessages(const QtMsgType type)
+{
+    if(!QtMessageFilterCore::good())
+        return 0;
+
+    return QtMessageFilterCore::m_singleton_instance->m_log_writer->dropped(type);
+}
+
+void QtMessageFilterCore::setSampling(const QtMsgType type, const SamplingMode mode, const double value)
+{
+    if(!QtMessageFilterCore::good())
+    {
+        qWarning()<<"You tried to call a method of the class QtMessageFilterCore when it was inactive,"
+                    " please call QtMessageFilterCore::resetInstance before use any method of this class.\n"
+                    "Thanks.";
+        return;
+    }
+
+    if(type == QtCriticalMsg || type == QtFatalMsg)
+    {
+        qWarning()<<"QtMessageFilterCore: critical and fatal messages can not be sampled.";
+        return;
+    }
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    QMutexLocker locker(&core->m_sampling_mutex);
+
+    if(!core->m_sampler_of_type[type])
+        core->m_sampling_count.ref();
+    core->m_sampler_of_type[type].reset(new QtMessageFilterSampler(mode, value));
+}
+
+void QtMessageFilterCore::setCategorySampling(const QString& category, const SamplingMode mode, const double value)
+{
+    if(!QtMessageFilterCore::good())
+    {
+        qWarning()<<"You tried to call a method of the class QtMessageFilterCore when it was inactive,"
+                    " please call QtMessageFilterCore::resetInstance before use any method of this class.\n"
+                    "Thanks.";
+        return;
+    }
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    QMutexLocker locker(&core->m_sampling_mutex);
+
+    if(!core->m_sampler_of_category.contains(category.toUtf8()))
+        core->m_sampling_count.ref();
+    core->m_sampler_of_category.insert(category.toUtf8(),
+                                       QSharedPointer<QtMessageFilterSampler>(new QtMessageFilterSampler(mode, value)));
+}
+
+void QtMessageFilterCore::clearSampling()
+{
+    if(!QtMessageFilterCore::good())
+        return;
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    QMutexLocker locker(&core->m_sampling_mutex);
+
+    for(QSharedPointer<QtMessageFilterSampler>& k : core->m_sampler_of_type)
+        k.reset();
+    core->m_sampler_of_category.clear();
+    core->m_sampling_count.storeRelease(0);
+}
+
+QtMessageFilterCore::Statistics QtMessageFilterCore::statistics()
+{
+    if(!QtMessageFilterCore::good())
+        return Statistics();
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    return core->f_statistics(core->m_log_writer->statistics());
+}
+
+void QtMessageFilterCore::setStatisticsInterval(const int interval)
+{
+    if(!QtMessageFilterCore::good())
+    {
+        qWarning()<<"You tried to call a method of the class QtMessageFilterCore when it was inactive,"
+                    " please call QtMessageFilterCore::resetInstance before use any method of this class.\n"
+                    "Thanks.";
+        return;
+    }
+
+    // The record is built on the writer thread, which is stopped before the instance is deleted
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    core->m_log_writer->setStatisticsRecord(interval, [core](const QtMessageFilterLogWriter::Statistics& writer)
+    {
+        return QtMessageFilterCore::f_statistics_record(core->f_statistics(writer)) + core->f_sampled_out_record();
+    });
+}
+
+void QtMessageFilterCore::setLastRenderedId(const qint64 id)
+{
+    if(QtMessageFilterCore::good())
+        QtMessageFilterCore::m_singleton_instance->m_last_rendered_id.storeRelease(id);
+}
+
+QList<QtMessageFilterCore::Location> QtMessageFilterCore::locations()
+{
+    if(!QtMessageFilterCore::good())
+        return QList<Location>();
+
+    return QtMessageFilterCore::m_singleton_instance->m_profiler.locations();
+}
+
+void QtMessageFilterCore::setLocationSilenced(const QString& fileName, const int line, const QString& function, const bool silenced)
+{
+    if(!QtMessageFilterCore::good())
+    {
+        qWarning()<<"You tried to call a method of the class QtMessageFilterCore when it was inactive,"
+                    " please call QtMessageFilterCore::resetInstance before use any method of this class.\n"
+                    "Thanks.";
+        return;
+    }
+
+    QtMessageFilterCore::m_singleton_instance->m_profiler.setSilenced(fileName, line, function, silenced);
+}
+
+void QtMessageFilterCore::clearLocations()
+{
+    if(QtMessageFilterCore::good())
+        QtMessageFilterCore::m_singleton_instance->m_profiler.clear();
+}
+
+bool QtMessageFilterCore::exportLocations(const QString& fileName)
+{
+    if(!QtMessageFilterCore::good())
+        return false;
+
+    // The noisiest locations first
+    QList<Location> list = QtMessageFilterCore::m_singleton_instance->m_profiler.locations();
+    std::sort(list.begin(), list.end(), [](const Location& a, const Location& b){ return a.count > b.count; });
+
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    const QByteArray csv = QtMessageFilterProfiler::toCsv(list);
+    return file.write(csv) == csv.size();
+}
+
+QString QtMessageFilterCore::templateText(const int templateId)
+{
+    if(!QtMessageFilterCore::good())
+        return QString();
+
+    return QString::fromUtf8(QtMessageFilterCore::m_singleton_instance->m_template_miner.templateOf(templateId));
+}
+
+quint64 QtMessageFilterCore::templateCount(const int templateId)
+{
+    if(!QtMessageFilterCore::good())
+        return 0;
+
+    return QtMessageFilterCore::m_singleton_instance->m_template_miner.countOf(templateId);
+}
+
+QList<QtMessageFilterCore::TemplateGroup> QtMessageFilterCore::templateGroups(const int types, const quintptr threadId)
+{
+    if(!QtMessageFilterCore::good())
+        return QList<TemplateGroup>();
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    QMutexLocker locker(&core->m_groups_mutex);
+
+    // The groups of the threads are merged when no thread is given
+    QHash<int, TemplateGroup> merged;
+    for(auto i = core->m_template_groups.constBegin(); i != core->m_template_groups.constEnd(); ++i)
+    {
+        if(threadId != 0 && i.key().second != threadId)
+            continue;
+
+        for(int type = 0; type < 5; type++)
+        {
+            if(!(types & (1 << type)) || i.value().count[type] == 0)
+                continue;
+
+            TemplateGroup& group = merged[i.key().first];
+            group.templateId = i.key().first;
+            group.count += i.value().count[type];
+            if(!group.last || group.last->id < i.value().last[type]->id)
+                group.last = i.value().last[type];
+        }
+    }
+
+    return merged.values();
+}
+
+void QtMessageFilterCore::setBinaryLogEnabled(const bool enabled)
+{
+    if(!QtMessageFilterCore::good())
+    {
+        qWarning()<<"You tried to call a method of the class QtMessageFilterCore when it was inactive,"
+                    " please call QtMessageFilterCore::resetInstance before use any method of this class.\n"
+                    "Thanks.";
+        return;
+    }
+
+    QtMessageFilterCore::m_singleton_instance->m_log_writer->setBinaryLog(enabled ? "QtMessageFilterLog.bin" : QString());
+}
+
+void QtMessageFilterCore::setOutputPattern(const QString& pattern)
+{
+    if(!QtMessageFilterCore::good())
+    {
+        qWarning()<<"You tried to call a method of the class QtMessageFilterCore when it was inactive,"
+                    " please call QtMessageFilterCore::resetInstance before use any method of this class.\n"
+                    "Thanks.";
+        return;
+    }
+
+    // Compiled before locking, the messages only wait for the assignment
+    const QtMessageFilterPattern compiled(pattern);
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+
+    // The records after the header are the ones of the new pattern, on the
+    //  order of the sequence taken with the assignment
+    qint64 sequence = -1;
+    {
+        QMutexLocker locker(&core->m_mutex);
+        core->m_output_pattern = compiled;
+        sequence = (qint64)core->m_log_sequence++;
+        core->m_writes_in_flight.ref();
+    }
+
+    core->m_log_writer->write(compiled.headerRecord(), QtInfoMsg, QtMessageFilterLogWriter::Block, -1,
+                              QSharedPointer<MessageDetails>(), QByteArray(), -1, sequence);
+    core->m_writes_in_flight.deref();
+}
+
+QString QtMessageFilterCore::outputPattern()
+{
+    if(!QtMessageFilterCore::good())
+        return QString();
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+    QMutexLocker locker(&core->m_mutex);
+    return core->m_output_pattern.pattern();
+}
+
+void QtMessageFilterCore::appendMessages(const QList<QSharedPointer<MessageDetails>>& messages, const QString& source)
+{
+    if(!QtMessageFilterCore::good())
+    {
+        qWarning()<<"You tried to call a method of the class QtMessageFilterCore when it was inactive,"
+                    " please call QtMessageFilterCore::resetInstance before use any method of this class.\n"
+                    "Thanks.";
+        return;
+    }
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+
+    // Numbered after the messages of this process, so the ids keep their order
+    QList<QSharedPointer<MessageDetails>> appended;
+    appended.reserve(messages.size());
+    {
+        QMutexLocker locker(&core->m_mutex);
+        for(const QSharedPointer<MessageDetails>& k : messages)
+        {
+            // The threads of the source are on their own lanes, named after it
+            const quintptr threadId = source.isEmpty() ? k->threadId : core->f_source_thread(source, k->threadId);
+            const QString threadName = source.isEmpty() ? k->threadName
+                                                        : k->threadName + " 0x" + QString::number(k->threadId, 16) +
+                                                          " (" + QFileInfo(source).fileName() + ")";
+
+            QSharedPointer<MessageDetails> messageInfo( new MessageDetails(k->type, k->line,
+                                                                           core->f_intern(k->fileNameUtf8.constData()),
+                                                                           core->f_intern(k->functionUtf8.constData()),
+                                                                           core->f_intern(k->categoryUtf8.constData()),
+                                                                           k->messageUtf8, core->m_last_id++,
+                                                                           k->dateTime, threadId, threadName,
+                                                                           -1, 0, k->sampledOut, k->stack) );
+            core->f_retain(messageInfo);
+            appended.append(messageInfo);
+        }
+        core->m_issued_ids.storeRelease(core->m_last_id);
+    }
+
+    // They are not written on the log file, so they are mined here
+    for(const QSharedPointer<MessageDetails>& k : appended)
+    {
+        k->templateId.storeRelease(core->m_template_miner.mine(k->messageUtf8).templateId);
+        core->f_group(k);
+        Q_EMIT core->signal_message_captured(k);
+    }
+}
+
+void QtMessageFilterCore::followLogFile(const QString& fileName, const qint64 backlogBytes)
+{
+    if(!QtMessageFilterCore::good())
+    {
+        qWarning()<<"You tried to call a method of the class QtMessageFilterCore when it was inactive,"
+                    " please call QtMessageFilterCore::resetInstance before use any method of this class.\n"
+                    "Thanks.";
+        return;
+    }
+
+    QtMessageFilterCore* core = QtMessageFilterCore::m_singleton_instance;
+
+    // Only one file is followed, the last one stops being followed
+    core->m_log_follower.reset();
+    if(fileName.isEmpty())
+        return;
+
+    core->m_log_follower.reset(new QtMessageFilterLogFollower(fileName, backlogBytes));
+    connect(core->m_log_follower.data(), &QtMessageFilterLogFollower::signal_messages,
+            core->m_log_follower.data(), [fileName](QList<QSharedPointer<MessageDetails>> messages)
+    {
+        QtMessageFilterCore::appendMessages(messages, fileName);
+    });
+}
+
+QString QtMessageFilterCore::followedLogFile()
+{
+    if(!QtMessageFilterCore::good() || !QtMessageFilterCore::m_singleton_instance->m_log_follower)
+        return QString();
+
+    return QtMessageFilterCore::m_singleton_instance->m_log_follower->fileName();
+}
+
+QtMessageFilterCore::QtMessageFilterCore(const ulong maximumRetainedBytes, const ulong maximumMessageBytes)
+    : QObject(nullptr),
+      m_mutex(),
+      m_messages(),
+      m_retained_total(0),
+      m_retained_bytes(0),
+      m_thread_lanes(),
+      m_last_id(0),
+      m_issued_ids(0),
+      m_source_threads(),
+      m_log_sequence(0),
+      m_writes_in_flight(0),
+      m_interned_strings(),
+      m_log_writer(new QtMessageFilterLogWriter("QtMessageFilterLog.txt")),
+      m_log_follower(),
+      m_output_pattern(QString::fromLocal8Bit(qgetenv("QT_MESSAGE_PATTERN"))),
+      m_template_miner(),
+      m_groups_mutex(),
+      m_template_groups(),
+      m_spill_mutex(),
+      m_spill_file("QtMessageFilterSpill.bin"),
+      m_spill_failure_reported(false),
+      m_spill_base(0),
+      m_spilled_live(),
+      m_spilled_live_bytes(0),
+      m_maximum_retained_bytes(maximumRetainedBytes),
+      m_maximum_message_bytes(maximumMessageBytes),
+      m_overload_of_type(),
+      m_overload_of_category(),
+      m_sampling_mutex(),
+      m_sampling_count(0),
+      m_sampler_of_type(),
+      m_sampler_of_category(),
+      m_profiler(),
+      m_captured(),
+      m_last_rendered_id(-1),
+      m_rate_mutex(),
+      m_rate_timer(),
+      m_rate_captured{0, 0, 0, 0, 0},
+      m_rate{0, 0, 0, 0, 0},
+      m_previous_message_handler(nullptr)
+{
+    for(OverloadSettings& k : m_overload_of_type)
+        k = OverloadSettings{QtMessageFilterLogWriter::Block, -1};
+
+    // Multi-thread support
+    qRegisterMetaType<QSharedPointer<MessageDetails>>();
+
+    m_rate_timer.start();
+
+    // The first call of backtrace() loads its library, better here than
+    //  on the first critical message
+    QtMessageFilterStackTrace::capture();
+
+    // The log file is removed, created and opened on the writer thread
+    m_log_writer->setTemplateMiner(&m_template_miner);
+    m_log_writer->setMinedCallback([this](const QSharedPointer<MessageDetails>& messageDetails)
+    {
+        f_group(messageDetails);
+    });
+
+    // The first record, right after the beginning, when QT_MESSAGE_PATTERN is set
+    if(!m_output_pattern.isDefault())
+        m_log_writer->write(m_output_pattern.headerRecord(), QtInfoMsg, QtMessageFilterLogWriter::Block, -1,
+                            QSharedPointer<MessageDetails>(), QByteArray(), -1, (qint64)m_log_sequence++);
+
+    m_log_writer->start();
+}
+
+QtMessageFilterCore::~QtMessageFilterCore()
+{
+    // Install the message handler that was replaced (the default one of Qt, usually)
+    qInstallMessageHandler(m_previous_message_handler);
+
+    // The messages that were already captured finish being queued on the log file
+    while(m_writes_in_flight.loadAcquire() > 0)
+        QThread::yieldCurrentThread();
+
+    QMutexLocker locker(&m_mutex);
+
+    // Write the pending records and the end of the log file
+    const QByteArray sampledOut = f_sampled_out_record();
+    if(!sampledOut.isEmpty())
+        m_log_writer->write(sampledOut, QtInfoMsg);
+    m_log_writer.reset();
+
+    // The truncated messages are released with the instance
+    if(m_spill_file.isOpen())
+        m_spill_file.remove();
+}
+
+void QtMessageFilterCore::f_message_filter(const QtMsgType type, const QMessageLogContext& context, const QString& msg)
+{
+    if(t_inside_message_handler)
+    {
+        fprintf(stderr, "%s\n", qPrintable(msg));
+        return;
+    }
+
+    if(QtMessageFilterCore::good())
+    {
+        t_inside_message_handler = true;
+        QtMessageFilterCore::m_singleton_instance->f_message_output(type, context, msg);
+        t_inside_message_handler = false;
+    }
+}
+
+void QtMessageFilterCore::f_message_output(const QtMsgType type,
+                                           const QMessageLogContext& context,
+                                           const QString& msg)
+{
+    // Encoded only once, the bytes of the location, the record of the log file and
+    //  the retained message are built from the same bytes. toUtf8() allocates 3 bytes
+    //  per character, the retained message keeps only the ones used
+    QByteArray full = msg.toUtf8();
+    full.squeeze();
+
+    // Every message is counted on its location, the silenced ones are discarded here
+    if(!m_profiler.count(context.file, context.line, context.function, full.size()) &&
+       type != QtFatalMsg)
+    {
+        return;
+    }
+
+    // The messages dropped by the sampling cost only the encoding and the lookup of their location
+    quint64 sampledOut = 0;
+    if(m_sampling_count.loadAcquire() > 0 && type != QtCriticalMsg && type != QtFatalMsg &&
+       !f_sample(type, context, &sampledOut))
+    {
+        return;
+    }
+
+    const ThreadIdentity& thread = f_current_thread_identity();
+
+    // Only the addresses, they are symbolized when shown or written. The frames
+    //  of this function and of the message handler are not interesting
+    QVector<quintptr> stack;
+    if(type == QtCriticalMsg || type == QtFatalMsg)
+        stack = QtMessageFilterStackTrace::capture(2);
+
+    // A message too long is truncated on memory, its full content is only read
+    //  from the spill file when requested. It is kept whole if it can not be spilled.
+    //  The spill file has its own mutex, it is written before taking the one of the messages
+    const qint64 spillOffset = type != QtFatalMsg && (ulong)full.size() > m_maximum_message_bytes ?
+                f_spill_message(full) : -1;
+
+    int retainedSize = full.size();
+    if(spillOffset >= 0)
+    {
+        // Not in the middle of the bytes of a character
+        retainedSize = (int)m_maximum_message_bytes;
+        while(retainedSize > 0 && (full.at(retainedSize) & 0xC0) == 0x80)
+            retainedSize--;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    const QDateTime dateTime = QDateTime::currentDateTime();
+
+    const QByteArray fileName = f_intern(context.file);
+    const QByteArray function = f_intern(context.function);
+    const QByteArray category = f_intern(context.category);
+
+    const QSharedPointer<MessageDetails> messageInfo( new MessageDetails(type, context.line, fileName, function, category,
+                                                                         spillOffset >= 0 ? QByteArray(full.constData(), retainedSize) : full,
+                                                                         m_last_id++, dateTime, thread.id, thread.name,
+                                                                         spillOffset, spillOffset >= 0 ? full.size() : 0,
+                                                                         sampledOut, stack) );
+
+    m_captured[type].fetchAndAddRelaxed(1);
+    m_issued_ids.storeRelease(m_last_id);
+
+    // The records are written on the order of this sequence, even if they
+    //  are queued on another order once the mutex is released
+    const qint64 sequence = (qint64)m_log_sequence++;
+
+    // The category policy has priority over the one of the type
+    OverloadSettings overload = m_overload_of_type[type];
+    if(type == QtFatalMsg)
+        overload = OverloadSettings{QtMessageFilterLogWriter::Block, -1};
+    else if(!m_overload_of_category.isEmpty() && context.category)
+        overload = m_overload_of_category.value(category, overload);
+
+    // Shares the operations with m_output_pattern, it may be changed once unlocked
+    const QtMessageFilterPattern pattern = m_output_pattern;
+
+    if(type != QtFatalMsg)
+        f_retain(messageInfo);
+
+    m_writes_in_flight.ref();
+    locker.unlock();
+
+    // Formatted and queued without the mutex, a producer waiting for space on
+    //  the queue of the log file does not stall the others. The pattern only copies bytes
+    QByteArray record;
+    record.reserve(pattern.literalSize() + 64 + fileName.size() + function.size() +
+                   category.size() + thread.nameUtf8.size() + full.size());
+
+    int stackOffset = -1;
+    pattern.format(&record, *messageInfo, full, thread.nameUtf8, &stackOffset);
+
+    m_log_writer->write(record, type, overload.policy, overload.timeout, messageInfo,
+                        spillOffset >= 0 ? full : QByteArray(), stackOffset, sequence);
+    m_writes_in_flight.deref();
+
+    if(type == QtFatalMsg)
+    {
+        // The record must be on the disk before the application is terminated
+        m_log_writer->flush();
+
+        // Without a front-end, return and let Qt abort the application
+        if(!this->isSignalConnected(QMetaMethod::fromSignal(&QtMessageFilterCore::signal_fatal_message)))
+            return;
+
+        // emit the signal to create a dialog message box showing the fatal error message
+        Q_EMIT signal_fatal_message(msg);
+
+        // Waits for the message to be closed and the application terminated
+        QEventLoop loop;
+        loop.exec();
+
+        return;
+    }
+
+    Q_EMIT signal_message_captured(messageInfo);
+}
+
+QByteArray QtMessageFilterCore::f_sampled_out_record()
+{
+    QList<QtMessageFilterSampler::SampledOut> list;
+    {
+        QMutexLocker locker(&m_sampling_mutex);
+
+        for(const QSharedPointer<QtMessageFilterSampler>& k : m_sampler_of_type)
+        {
+            if(k)
+                list.append(k->takeSampledOut());
+        }
+        for(const QSharedPointer<QtMessageFilterSampler>& k : qAsConst(m_sampler_of_category))
+            list.append(k->takeSampledOut());
+    }
+
+    if(list.isEmpty())
+        return QByteArray();
+
+    // As "<file> <line> <count>", the file may have spaces
+    QByteArray locations;
+    for(const QtMessageFilterSampler::SampledOut& k : qAsConst(list))
+        locations += k.fileName + ' ' + QByteArray::number(k.line) + ' ' + QByteArray::number(k.count) + '\n';
+
+    return "<<<<<<<<<<<<<<<sampled_out<<<<<<<<<<<<<<<\n"
+           "\\time_date:\n" +
+           QDateTime::currentDateTime().toString(Qt::ISODateWithMs).toUtf8() + "\n\n"
+           "\\sampled_out:\n" +
+           locations +
+           ">>>>>>>>>>>>>>>sampled_out>>>>>>>>>>>>>>>\n";
+}
+
+bool QtMessageFilterCore::f_sample(const QtMsgType type, const QMessageLogContext& context, quint64* sampledOut)
+{
+    QMutexLocker locker(&m_sampling_mutex);
+
+    // The sampler of the category has priority over the one of the type
+    QtMessageFilterSampler* sampler = m_sampler_of_type[type].get();
+    if(!m_sampler_of_category.isEmpty() && context.category)
+    {
+        const QByteArray category = QByteArray::fromRawData(context.category, (int)qstrlen(context.category));
+        auto i = m_sampler_of_category.constFind(category);
+        if(i != m_sampler_of_category.constEnd())
+            sampler = i.value().get();
+    }
+
+    return !sampler || sampler->sample(context.file, context.line, sampledOut);
+}
+
+QtMessageFilterCore::Statistics QtMessageFilterCore::f_statistics(const QtMessageFilterLogWriter::Statistics& writer)
+{
+    Statistics statistics;
+    statistics.writer = writer;
+
+    quint64 total = 0;
+    for(int i = 0; i < 5; i++)
+    {
+        statistics.captured[i] = m_captured[i].loadAcquire();
+        total += statistics.captured[i];
+    }
+
+    {
+        // The rate is updated when the last window has at least one second
+        QMutexLocker locker(&m_rate_mutex);
+
+        const qint64 elapsed = m_rate_timer.elapsed();
+        if(elapsed >= 1000)
+        {
+            for(int i = 0; i < 5; i++)
+            {
+                m_rate[i] = (statistics.captured[i] - m_rate_captured[i])*1000.0/elapsed;
+                m_rate_captured[i] = statistics.captured[i];
+            }
+            m_rate_timer.restart();
+        }
+
+        for(int i = 0; i < 5; i++)
+            statistics.messagesPerSecond[i] = m_rate[i];
+    }
+
+    statistics.retainedBytes = m_retained_bytes.loadAcquire();
+
+    // The ids issued after the last one rendered, the appended messages have ids
+    //  too but they are not counted as captured
+    const qint64 rendered = m_last_rendered_id.loadAcquire();
+    statistics.renderLag = rendered < 0 ? -1 : qMax<qint64>(0, (qint64)m_issued_ids.loadAcquire() - 1 - rendered);
+
+    statistics.templates = m_template_miner.templateCount();
+    statistics.templatesEvicted = m_template_miner.evictedCount();
+
+    return statistics;
+}
+
+QByteArray QtMessageFilterCore::f_statistics_record(const Statistics& statistics)
+{
+    auto ofTypes = [](const quint64* values)
+    {
+        return "debug " + QByteArray::number(values[QtDebugMsg]) +
+                " info " + QByteArray::number(values[QtInfoMsg]) +
+                " warning " + QByteArray::number(values[QtWarningMsg]) +
+                " critical " + QByteArray::number(values[QtCriticalMsg]) +
+                " fatal " + QByteArray::number(values[QtFatalMsg]);
+    };
+
+    QByteArray rate;
+    for(const QtMsgType type : {QtDebugMsg, QtInfoMsg, QtWarningMsg, QtCriticalMsg, QtFatalMsg})
+        rate += ' ' + QByteArray::number(statistics.messagesPerSecond[type], 'f', 1);
+
+    // Only the buckets with some flush, as "<upper limit in microseconds>:<count>"
+    QByteArray flushLatency;
+    for(int i = 0; i < QtMessageFilterLogWriter::FlushLatencyBuckets; i++)
+    {
+        if(statistics.writer.flushLatency[i] > 0)
+            flushLatency += " <" + QByteArray::number(2ull << i) + ':' + QByteArray::number(statistics.writer.flushLatency[i]);
+    }
+
+    return "<<<<<<<<<<<<<<<statistics<<<<<<<<<<<<<<<\n"
+           "\\time_date:\n" +
+           QDateTime::currentDateTime().toString(Qt::ISODateWithMs).toUtf8() + "\n\n"
+           "\\statistics:\n"
+           "captured " + ofTypes(statistics.captured) + "\n"
+           "messages_per_second" + rate + "\n"
+           "retained_bytes " + QByteArray::number(statistics.retainedBytes) + "\n"
+           "render_lag " + QByteArray::number(statistics.renderLag) + "\n"
+           "templates " + QByteArray::number(statistics.templates) +
+           " evicted " + QByteArray::number(statistics.templatesEvicted) + "\n"
+           "bytes_written " + QByteArray::number(statistics.writer.bytesWritten) + "\n"
+           "records_written " + QByteArray::number(statistics.writer.recordsWritten) + "\n"
+           "queue_depth " + QByteArray::number(statistics.writer.queueDepth) +
+           " of " + QByteArray::number(statistics.writer.queueCapacity) + "\n"
+           "dropped " + ofTypes(statistics.writer.dropped) + "\n"
+           "flush_latency_us" + flushLatency + "\n"
+           ">>>>>>>>>>>>>>>statistics>>>>>>>>>>>>>>>\n";
+}
+
+void QtMessageFilterCore::f_retain(const QSharedPointer<MessageDetails>& messageDetails)
+{
+    // Must be called with m_mutex locked
+
+    // Release the oldest messages until the retained ones fit on the budget
+    m_messages.append(messageDetails);
+    m_thread_lanes[messageDetails->threadId].append(messageDetails);
+    m_retained_total += messageDetails->bytes;
+    {
+        QMutexLocker locker(&m_groups_mutex);
+        messageDetails->retained = true;
+    }
+    while(m_retained_total > (qint64)m_maximum_retained_bytes && !m_messages.isEmpty())
+    {
+        const QSharedPointer<MessageDetails> oldest = m_messages.takeFirst();
+        m_retained_total -= oldest->bytes;
+        f_remove_from_thread_lane(oldest, true);
+        f_ungroup(oldest);
+        f_release_spill(*oldest);
+    }
+
+    // Published only within the budget, the readers do not lock m_mutex
+    m_retained_bytes.storeRelease(m_retained_total);
+}
+
+void QtMessageFilterCore::f_remove_from_thread_lane(const QSharedPointer<MessageDetails>& messageDetails, const bool oldest)
+{
+    // Must be called with m_mutex locked
+    auto lane = m_thread_lanes.find(messageDetails->threadId);
+    if(lane == m_thread_lanes.end())
+        return;
+
+    // The oldest message retained is also the oldest of its lane
+    if(oldest && !lane->isEmpty() && lane->first() == messageDetails)
+        lane->removeFirst();
+    else
+        lane->removeOne(messageDetails);
+
+    if(lane->isEmpty())
+        m_thread_lanes.erase(lane);
+}
+
+void QtMessageFilterCore::f_group(const QSharedPointer<MessageDetails>& messageDetails)
+{
+    // Called once the message is mined, from the writer thread or by appendMessages
+    QMutexLocker locker(&m_groups_mutex);
+
+    // Released before being mined, or never retained (fatal messages)
+    if(!messageDetails->retained || messageDetails->grouped)
+        return;
+    messageDetails->grouped = true;
+
+    GroupCounter& group = m_template_groups[qMakePair(messageDetails->templateId.loadAcquire(), messageDetails->threadId)];
+    group.count[messageDetails->type]++;
+    if(!group.last[messageDetails->type] || group.last[messageDetails->type]->id < messageDetails->id)
+        group.last[messageDetails->type] = messageDetails;
+}
+
+void QtMessageFilterCore::f_ungroup(const QSharedPointer<MessageDetails>& messageDetails)
+{
+    // Must be called with m_mutex locked, when the message is released
+    QMutexLocker locker(&m_groups_mutex);
+
+    messageDetails->retained = false;
+    if(!messageDetails->grouped)
+        return;
+    messageDetails->grouped = false;
+
+    auto group = m_template_groups.find(qMakePair(messageDetails->templateId.loadAcquire(), messageDetails->threadId));
+    if(group == m_template_groups.end())
+        return;
+
+    // The newest message of a group is only replaced when it is emptied
+    if(--group->count[messageDetails->type] == 0)
+        group->last[messageDetails->type].reset();
+
+    for(const quint64 count : group->count)
+    {
+        if(count > 0)
+            return;
+    }
+    m_template_groups.erase(group);
+}
+
+quintptr QtMessageFilterCore::f_source_thread(const QString& source, const quintptr threadId)
+{
+    // Must be called with m_mutex locked
+
+    // The ids of the threads of this process are addresses (or multiples of 4 on
+    //  Windows), so the odd ones given to the threads of the sources never collide
+    auto i = m_source_threads.constFind(qMakePair(source, threadId));
+    if(i != m_source_threads.constEnd())
+        return i.value();
+
+    const quintptr id = (quintptr)m_source_threads.size()*2 + 1;
+    m_source_threads.insert(qMakePair(source, threadId), id);
+    return id;
+}
+
+QByteArray QtMessageFilterCore::f_intern(const char* str)
+{
+    // Must be called with m_mutex locked
+    if(!str)
+        return QByteArray();
+
+    // Looked for without copying, only a new string is copied
+    const QByteArray key = QByteArray::fromRawData(str, (int)qstrlen(str));
+    auto i = m_interned_strings.constFind(key);
+    if(i != m_interned_strings.constEnd())
+        return *i;
+
+    const QByteArray copy(key.constData(), key.size());
+    m_interned_strings.insert(copy);
+    return copy;
+}
+
+qint64 QtMessageFilterCore::f_spill_message(const QByteArray& message)
+{
+    QMutexLocker locker(&m_spill_mutex);
+
+    // The spill file of the last session is overwritten
+    qint64 offset = -1;
+    if(m_spill_file.isOpen() || m_spill_file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+    {
+        f_compact_spill_file();
+
+        const qint64 size = m_spill_file.size();
+        if(m_spill_file.seek(size) && m_spill_file.write(message) == message.size())
+        {
+            offset = m_spill_base + size;
+            m_spilled_live.insert(offset, message.size());
+            m_spilled_live_bytes += message.size();
+        }
+    }
+
+    // Reported once, on stderr since this runs inside the message handler
+    if(offset < 0 && !m_spill_failure_reported)
+    {
+        m_spill_failure_reported = true;
+        fprintf(stderr, "QtMessageFilterCore: could not write the spill file %s (%s), "
+                        "the long messages will be retained whole\n",
+                qPrintable(m_spill_file.fileName()), qPrintable(m_spill_file.errorString()));
+    }
+
+    return offset;
+}
+
+
+void QtMessageFilterCore::f_compact_spill_file()
+{
+    // Must be called with m_spill_mutex locked
+
+    // Only when the file is big and mostly made of released messages
+    const qint64 size = m_spill_file.size();
+    if(size < qMax<qint64>(1024*1024, (qint64)m_maximum_retained_bytes) || m_spilled_live_bytes*4 >= size)
+        return;
+
+    // The bytes from the oldest retained message to the end are moved to the
+    //  beginning of the file, by parts, the offsets of the messages do not change
+    //  The messages are released from the oldest, the ones removed out of order
+    //  only leave holes, so it is not worth it when little is discarded
+    const qint64 begin = m_spilled_live.isEmpty() ? m_spill_base + size : m_spilled_live.firstKey();
+    if((begin - m_spill_base)*2 < size)
+        return;
+
+    qint64 moved = 0;
+    while(m_spill_base + size > begin + moved)
+    {
+        const QByteArray data = m_spill_file.seek(begin + moved - m_spill_base) ?
+                    m_spill_file.read(qMin<qint64>(1024*1024, m_spill_base + size - begin - moved)) : QByteArray();
+        if(data.isEmpty() || !m_spill_file.seek(moved) || m_spill_file.write(data) != data.size())
+        {
+            // Moved in half, every spilled message is lost (they keep their retained beginning)
+            m_spill_file.resize(0);
+            m_spill_base += size;
+            m_spilled_live.clear();
+            m_spilled_live_bytes = 0;
+            return;
+        }
+        moved += data.size();
+    }
+
+    m_spill_file.resize(moved);
+    m_spill_base = begin;
+}
+
+void QtMessageFilterCore::f_release_spill(const MessageDetails& details)
+{
+    // Called when the message is released, with m_mutex locked
+    if(!details.isTruncated())
+        return;
+
+    QMutexLocker locker(&m_spill_mutex);
+    if(m_spilled_live.remove(details.spillOffset) > 0)
+        m_spilled_live_bytes -= details.spillSize;
+}
+
+MessageDetails::MessageDetails(const QtMsgType thatType,
+                               const int thatLine,
+                               const QByteArray& thatFileName,
+                               const QByteArray& thatFunction,
+                               const QByteArray& thatCategory,
+                               const QByteArray& thatMessage,
+                               const ulong thatId,
+                               const QDateTime thatDateTime,
+                               const quintptr thatThreadId,
+                               const QString& thatThreadName,
+                               const qint64 thatSpillOffset,
+                               const qint64 thatSpillSize,
+                               const quint64 thatSampledOut,
+                               const QVector<quintptr>& thatStack) :
+    type(thatType),
+    line(thatLine),
+    fileNameUtf8(thatFileName),
+    functionUtf8(thatFunction),
+    categoryUtf8(thatCategory),
+    // Charged by its capacity, so it keeps only the bytes used
+    messageUtf8(thatMessage.capacity() > thatMessage.size() ? QByteArray(thatMessage.constData(), thatMessage.size())
+                                                            : thatMessage),
+    id(thatId),
+    dateTime(thatDateTime),
+    threadId(thatThreadId),
+    threadName(thatThreadName),
+    spillOffset(thatSpillOffset),
+    spillSize(thatSpillSize),
+    sampledOut(thatSampledOut),
+    stack(thatStack),
+    bytes(f_compute_bytes()),
+    templateId(-1),
+    retained(false),
+    grouped(false)
+{
+
+}
+
+MessageDetails::~MessageDetails()
+{
+
+}
+
+QString MessageDetails::fileName() const
+{
+    return QString::fromUtf8(fileNameUtf8);
+}
+
+QString MessageDetails::function() const
+{
+    return QString::fromUtf8(functionUtf8);
+}
+
+QString MessageDetails::category() const
+{
+    return QString::fromUtf8(categoryUtf8);
+}
+
+QString MessageDetails::message() const
+{
+    return QString::fromUtf8(messageUtf8);
+}
+
+bool MessageDetails::isTruncated() const
+{
+    return spillOffset >= 0;
+}
+
+qint64 MessageDetails::f_compute_bytes() const
+{
+    // The strings of the location are shared by every message of the
+    //  location (see QtMessageFilterCore::f_intern), only the message
+    //  is counted, with its header and null terminator
+    const qint64 record = (qint64)sizeof(MessageDetails) +
+            (qint64)sizeof(QArrayData) + messageUtf8.capacity() + 1 +
+            (stack.isEmpty() ? 0 : (qint64)sizeof(QArrayData) + stack.capacity()*(qint64)sizeof(quintptr));
+
+    // Once retained, the control block of its QSharedPointer (counters, destroyer
+    //  and deleter) and its entries on the messages and on its lane: a QList keeps
+    //  each QSharedPointer on its own node, besides the slot of the array
+    const qint64 sharedPointer = 4*(qint64)sizeof(void*);
+    const qint64 listEntry = (qint64)sizeof(void*) + (qint64)sizeof(QSharedPointer<MessageDetails>);
+
+    return record + sharedPointer + 2*listEntry;
+}
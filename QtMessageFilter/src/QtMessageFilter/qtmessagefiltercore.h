@@ -0,0 +1,492 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef QTMESSAGEFILTERCORE_H
+#define QTMESSAGEFILTERCORE_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QMutex>
+#include <QDateTime>
+#include <QSharedPointer>
+#include <QScopedPointer>
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QByteArray>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QPair>
+#include <QSet>
+#include <QVector>
+
+#include <functional>
+
+#include "qtmessagefilterlogwriter.h"
+#include "qtmessagefiltersampler.h"
+#include "qtmessagefilterprofiler.h"
+#include "qtmessagefiltertemplateminer.h"
+#include "qtmessagefilterstacktrace.h"
+#include "qtmessagefilterpattern.h"
+#include "qtmessagefilterlogfollower.h"
+
+
+///
+/// \brief This struct contains all information of a log message
+/// \details It is very similar to [QMessageLogContext](https://doc.qt.io/qt-5/qmessagelogcontext.html),
+/// but it has some additional information (the id of the message for the class
+/// QtMessageFilter and the time of generation of the message). The id of the message
+/// is count of messages when the message was generated, that way, the first message will
+/// have id=0, the seconde one will have id=1 and so on.
+/// It also hold not just the context of the message but the message itself.
+///
+/// The strings are kept as UTF-8 (`fileNameUtf8`, `functionUtf8`, `categoryUtf8` and
+/// `messageUtf8`), encoded only once when the message is captured, the same bytes are
+/// written on the log file. They are only decoded by MessageDetails::fileName(),
+/// MessageDetails::function(), MessageDetails::category() and MessageDetails::message(),
+/// when they are shown. The strings of the location are shared by all the messages of
+/// the same location.
+///
+/// When the message is longer than the limit of QtMessageFilterCore, only
+/// its beginning is retained on `messageUtf8` and the full message is saved on
+/// a spill file, it can be loaded with QtMessageFilterCore::fullMessage().
+/// If the spill file can not be written, the full message is retained.
+///
+/// `bytes` is an estimate of the memory retained by the record: the struct itself,
+/// the message, the stack, the control block of its QSharedPointer and its entries
+/// on the lists of QtMessageFilterCore. The headers of the allocator and the spare
+/// capacity of the lists are not counted, so it is approximate.
+///
+/// `threadId` and `threadName` identify the thread that generated the message,
+/// the name is the objectName of its QThread (or "main" for the thread of the
+/// application), read the first time the thread generates a message.
+///
+/// `sampledOut` is the count of messages of the same location that were dropped
+/// by the sampling of QtMessageFilterCore since the last one kept, that way this
+/// message represents `sampledOut + 1` messages.
+///
+/// `stack` is the call stack of the critical and fatal messages, only the return
+/// addresses, QtMessageFilterStackTrace::toText() converts it to the names of the
+/// functions (it is empty for the other types and on platforms without `backtrace()`).
+///
+/// `templateId` is the template of the message (see QtMessageFilterTemplateMiner),
+/// it is -1 until the message is mined by the writer of the log file, shortly after
+/// being captured. `retained` and `grouped` tell if the message is retained by
+/// QtMessageFilterCore and counted on its template groups, they are only used by it.
+///
+struct MessageDetails
+{
+    const QtMsgType type;
+    const int line;
+
+    const QByteArray fileNameUtf8;
+    const QByteArray functionUtf8;
+    const QByteArray categoryUtf8;
+
+    const QByteArray messageUtf8;
+
+    const ulong id;
+    const QDateTime dateTime;
+
+    const quintptr threadId;
+    const QString threadName;
+
+    const qint64 spillOffset;
+    const qint64 spillSize;
+
+    const quint64 sampledOut;
+
+    const QVector<quintptr> stack;
+
+    const qint64 bytes;
+
+    mutable QAtomicInt templateId;
+
+    mutable bool retained;
+    mutable bool grouped;
+
+    MessageDetails(const QtMsgType thatType,
+                   const int thatLine,
+                   const QByteArray& thatFileName,
+                   const QByteArray& thatFunction,
+                   const QByteArray& thatCategory,
+                   const QByteArray& thatMessage,
+                   const ulong thatId,
+                   const QDateTime thatDateTime,
+                   const quintptr thatThreadId,
+                   const QString& thatThreadName,
+                   const qint64 thatSpillOffset = -1,
+                   const qint64 thatSpillSize = 0,
+                   const quint64 thatSampledOut = 0,
+                   const QVector<quintptr>& thatStack = QVector<quintptr>());
+
+    ~MessageDetails();
+
+    QString fileName() const;
+    QString function() const;
+    QString category() const;
+    QString message() const;
+
+    bool isTruncated() const;
+
+private:
+    qint64 f_compute_bytes() const;
+};
+Q_DECLARE_METATYPE(QSharedPointer<MessageDetails>)
+
+
+///
+/// \brief This class is the engine of QtMessageFilter
+/// \details It only depends on QtCore, so it can be used on headless
+/// applications (services, command line tools, servers...) that do not
+/// link QtWidgets or do not have a display. It is a Singleton class, it
+/// can be initialized calling QtMessageFilterCore::resetInstance(), which
+/// installs the message handler of the class. Each message is written on
+/// the log file and retained on memory, the last messages can be recovered
+/// with QtMessageFilterCore::messagesOfType() and
+/// QtMessageFilterCore::lastMessages(). The messages of each thread are also
+/// indexed on their own lane, QtMessageFilterCore::threads() lists the threads
+/// with retained messages and QtMessageFilterCore::lastMessages() can read only
+/// the lane of one thread. QtMessageFilterCore::retainedIds() and
+/// QtMessageFilterCore::messagesInRange() read the retained messages by parts, so
+/// a long reader (like QtMessageFilterSearch) never holds the mutex for all of them.
+///
+/// The retention is limited by a memory budget (maximumRetainedBytes), the
+/// oldest messages are released when the bytes of the retained records
+/// exceed it. Messages longer than maximumMessageBytes are truncated on
+/// memory, the full message is saved on the file QtMessageFilterSpill.bin
+/// and loaded on demand by QtMessageFilterCore::fullMessage(). The spill file is
+/// compacted when the bytes of the retained messages are less than a quarter of
+/// it: the bytes before the oldest retained message are discarded, so it does
+/// not grow without end on long sessions. The full content of a message released
+/// before the compaction is lost, QtMessageFilterCore::fullMessage() then returns
+/// its retained beginning.
+///
+/// When the messages are generated faster than they can be written, the queue
+/// of the log file is limited and the messages are treated according to an
+/// OverloadPolicy (see QtMessageFilterLogWriter), chosen for each type with
+/// QtMessageFilterCore::setOverloadPolicy() or for each category with
+/// QtMessageFilterCore::setCategoryOverloadPolicy(). The default policy blocks
+/// the caller until there is space on the queue, so no message is lost. The message
+/// is queued after the mutex of the retained messages is released, so only the thread
+/// of a blocked message waits, the records keep the order of their ids on the log file.
+///
+/// High volume types or categories can be sampled with
+/// QtMessageFilterCore::setSampling() and QtMessageFilterCore::setCategorySampling(),
+/// only a sample of their messages is then retained and written (see
+/// QtMessageFilterSampler). The dropped messages are counted on their location
+/// and the log file shows how many messages each kept one represents. The messages
+/// dropped after the last one kept of a location are written on the log file as a
+/// "\sampled_out:" record with the periodic statistics, by QtMessageFilterCore::flush()
+/// and when the instance is released.
+/// Critical and fatal messages are never sampled.
+///
+/// The log file is opened and written on a QtMessageFilterLogWriter thread,
+/// so initializing the class does not touch the disk and generating a message
+/// only costs formatting its record.
+///
+/// The messages of each location of the code (file, line and function) are
+/// counted on capture by a QtMessageFilterProfiler, QtMessageFilterCore::locations()
+/// returns the count, the bytes and the rate of each one, so the noisiest ones can
+/// be found, and QtMessageFilterCore::exportLocations() saves them as CSV. A noisy
+/// location can be silenced with QtMessageFilterCore::setLocationSilenced(), its
+/// messages are then discarded right after being counted (fatal messages are
+/// never discarded).
+///
+/// Each message is assigned to a template (like "Teste <*>") by a
+/// QtMessageFilterTemplateMiner on the writer thread, QtMessageFilterCore::templateText()
+/// returns the text of a template. With QtMessageFilterCore::setBinaryLogEnabled() the
+/// messages are also written on QtMessageFilterLog.bin, with only the id of their
+/// template and their parameters. The retained messages are counted on a group for
+/// each template, type and thread as they are mined, so QtMessageFilterCore::templateGroups()
+/// returns the groups without reading the retained messages.
+///
+/// The records of the log file are formatted by a QtMessageFilterPattern, which uses
+/// the placeholders of qSetMessagePattern(). It is taken from the environment variable
+/// QT_MESSAGE_PATTERN when it is set (the default pattern otherwise) and can be changed
+/// with QtMessageFilterCore::setOutputPattern(). A pattern other than the default one
+/// is written on the log file before its records (see QtMessageFilterPattern::headerRecord()),
+/// so QtMessageFilterLogReader skips the records it can not read and reports them.
+///
+/// The log file of another process can be followed, like "tail -f", with
+/// QtMessageFilterCore::followLogFile() (see QtMessageFilterLogFollower). Its messages
+/// are given new ids, after the ones of this process, and are retained and emitted as
+/// the captured ones with QtMessageFilterCore::appendMessages(), but they are not
+/// written on the log file. The threads of a source (the followed file) are given their
+/// own ids, so their lanes never mix with the threads of this process, and their names
+/// tell the original id and the source. It must be called from a thread with an event loop.
+///
+/// QtMessageFilterCore::statistics() tells how the filter itself is coping:
+/// messages per second of each type, bytes written, depth of the queue of the
+/// log file, dropped messages, a histogram of the latency of the flushes of the
+/// log file, how many messages the front-end has not rendered yet and the templates
+/// kept and evicted by the miner. It only
+/// reads atomic counters, so it can be called often and from any thread. With
+/// QtMessageFilterCore::setStatisticsInterval() the same counters are written
+/// periodically on the log file as a "\statistics:" record.
+///
+/// A front-end (like the QtMessageFilter dialog) can connect to the signal
+/// QtMessageFilterCore::signal_message_captured, which is emitted for every
+/// message captured, from the thread that generated the message.
+///
+/// If no front-end is connected to QtMessageFilterCore::signal_fatal_message,
+/// a fatal message is written on the log file and the application is
+/// aborted as the default message handler of Qt would do.
+///
+/// To delete the instance of the class and reinstall the message handler it
+/// replaced (the default one, unless another was installed before), call
+/// QtMessageFilterCore::releaseInstance().
+///
+class QtMessageFilterCore : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    static void resetInstance(const ulong maximumRetainedBytes = 16*1024*1024, const ulong maximumMessageBytes = 64*1024);
+    static void releaseInstance();
+    static bool good();
+    static QtMessageFilterCore* instance();
+
+    static QList<QSharedPointer<MessageDetails>> messagesOfType(const QtMsgType type);
+    static QList<QSharedPointer<MessageDetails>> lastMessages(const int count,
+                                                              std::function<bool(const MessageDetails&)> accept = nullptr,
+                                                              const quintptr threadId = 0);
+    static bool retainedIds(ulong* firstId, ulong* lastId);
+    static QList<QSharedPointer<MessageDetails>> messagesInRange(const ulong fromId, const ulong toId,
+                                                                 const quintptr threadId = 0);
+    static QList<QPair<quintptr, QString>> threads();
+    static void removeMessage(QSharedPointer<MessageDetails> messageDetails);
+    static QString fullMessage(const MessageDetails& details);
+    static qint64 retainedBytes();
+    static void flush();
+
+    typedef QtMessageFilterLogWriter::OverloadPolicy OverloadPolicy;
+
+    static void setOverloadPolicy(const QtMsgType type, const OverloadPolicy policy, const int timeout = -1);
+    static void setCategoryOverloadPolicy(const QString& category, const OverloadPolicy policy, const int timeout = -1);
+    static void setWriterQueueCapacity(const int capacity);
+    static quint64 droppedMessages(const QtMsgType type);
+
+    typedef QtMessageFilterSampler::Mode SamplingMode;
+
+    static void setSampling(const QtMsgType type, const SamplingMode mode, const double value);
+    static void setCategorySampling(const QString& category, const SamplingMode mode, const double value);
+    static void clearSampling();
+
+    struct Statistics
+    {
+        // Indexed by QtMsgType
+        quint64 captured[5];
+        double messagesPerSecond[5];
+
+        qint64 retainedBytes;
+
+        // Messages captured (or appended) after the last one rendered by the front-end,
+        //  -1 when no front-end is rendering
+        qint64 renderLag;
+
+        // Templates kept by the miner and the ones evicted to bound it
+        int templates;
+        quint64 templatesEvicted;
+
+        QtMessageFilterLogWriter::Statistics writer;
+    };
+
+    static Statistics statistics();
+    static void setStatisticsInterval(const int interval);
+    static void setLastRenderedId(const qint64 id);
+
+    typedef QtMessageFilterProfiler::Location Location;
+
+    static QList<Location> locations();
+    static void setLocationSilenced(const QString& fileName, const int line, const QString& function, const bool silenced);
+    static void clearLocations();
+    static bool exportLocations(const QString& fileName);
+
+    static QString templateText(const int templateId);
+    static quint64 templateCount(const int templateId);
+
+    struct TemplateGroup
+    {
+        int templateId;
+
+        // Retained messages of the group and the newest of them
+        quint64 count;
+        QSharedPointer<MessageDetails> last;
+    };
+
+    static QList<TemplateGroup> templateGroups(const int types, const quintptr threadId = 0);
+    static void setBinaryLogEnabled(const bool enabled);
+
+    static void setOutputPattern(const QString& pattern);
+    static QString outputPattern();
+
+    static void appendMessages(const QList<QSharedPointer<MessageDetails>>& messages, const QString& source = QString());
+    static void followLogFile(const QString& fileName, const qint64 backlogBytes = 1024*1024);
+    static QString followedLogFile();
+
+private:
+
+    QtMessageFilterCore(const ulong maximumRetainedBytes = 16*1024*1024, const ulong maximumMessageBytes = 64*1024);
+    QtMessageFilterCore(const QtMessageFilterCore& that) = delete;
+    QtMessageFilterCore(QtMessageFilterCore&& that) = delete;
+    ~QtMessageFilterCore();
+
+    static QtMessageFilterCore* m_singleton_instance;
+
+    static void f_message_filter(const QtMsgType type,
+                                 const QMessageLogContext& context,
+                                 const QString& msg);
+
+    void f_message_output(const QtMsgType type,
+                          const QMessageLogContext& context,
+                          const QString& msg);
+
+    qint64 f_spill_message(const QByteArray& message);
+    void f_compact_spill_file();
+    void f_release_spill(const MessageDetails& details);
+    QByteArray f_intern(const char* str);
+    quintptr f_source_thread(const QString& source, const quintptr threadId);
+
+    bool f_sample(const QtMsgType type, const QMessageLogContext& context, quint64* sampledOut);
+    QByteArray f_sampled_out_record();
+
+    void f_retain(const QSharedPointer<MessageDetails>& messageDetails);
+    void f_remove_from_thread_lane(const QSharedPointer<MessageDetails>& messageDetails, const bool oldest);
+
+    void f_group(const QSharedPointer<MessageDetails>& messageDetails);
+    void f_ungroup(const QSharedPointer<MessageDetails>& messageDetails);
+
+    Statistics f_statistics(const QtMessageFilterLogWriter::Statistics& writer);
+    static QByteArray f_statistics_record(const Statistics& statistics);
+
+    struct OverloadSettings
+    {
+        OverloadPolicy policy;
+        int timeout;
+    };
+
+    // Protect the messages list, the id and the order of the records
+    //  on the log file, messages can be generated from any thread
+    mutable QMutex m_mutex;
+
+    // Retained messages, on the order they were generated
+    QList<QSharedPointer<MessageDetails>> m_messages;
+    // m_retained_total is updated under m_mutex, m_retained_bytes is its copy
+    //  for the readers, stored once the oldest messages were released
+    qint64 m_retained_total;
+    QAtomicInteger<qint64> m_retained_bytes;
+
+    // The same messages, on a lane for each thread
+    QHash<quintptr, QList<QSharedPointer<MessageDetails>>> m_thread_lanes;
+
+    ulong m_last_id;
+
+    // m_last_id for the readers of statistics, it also counts the appended messages
+    QAtomicInteger<qint64> m_issued_ids;
+
+    // Ids of the lanes of the threads of each source of appended messages
+    QHash<QPair<QString, quintptr>, quintptr> m_source_threads;
+
+    // Order of the records on the log file, only the messages written take one.
+    //  m_writes_in_flight counts the records being queued without m_mutex
+    quint64 m_log_sequence;
+    QAtomicInt m_writes_in_flight;
+
+    // Files, functions and categories of the messages, stored once
+    QSet<QByteArray> m_interned_strings;
+
+    QScopedPointer<QtMessageFilterLogWriter> m_log_writer;
+
+    // Log file of another process, whose messages are appended to the retained ones
+    QScopedPointer<QtMessageFilterLogFollower> m_log_follower;
+
+    // Format of the records of the log file, compiled once
+    QtMessageFilterPattern m_output_pattern;
+
+    // Mined by the writer thread and by appendMessages (on the thread of the
+    //  caller), it must outlive m_log_writer
+    QtMessageFilterTemplateMiner m_template_miner;
+
+    struct GroupCounter
+    {
+        // Indexed by QtMsgType
+        quint64 count[5];
+        QSharedPointer<MessageDetails> last[5];
+    };
+
+    // Retained messages of each template and thread, counted as they are mined.
+    //  m_groups_mutex is never locked before m_mutex, the writer thread only locks it
+    QMutex m_groups_mutex;
+    QHash<QPair<int, quintptr>, GroupCounter> m_template_groups;
+
+    // Full content of the truncated messages, opened on the first spill.
+    //  The offsets of the messages never change, m_spill_base is the offset of
+    //  the first byte of the file once the bytes before it were discarded.
+    //  m_spilled_live has the offset and the size of the retained messages
+    QMutex m_spill_mutex;
+    QFile m_spill_file;
+    bool m_spill_failure_reported;
+    qint64 m_spill_base;
+    QMap<qint64, qint64> m_spilled_live;
+    qint64 m_spilled_live_bytes;
+
+    const ulong m_maximum_retained_bytes;
+    const ulong m_maximum_message_bytes;
+
+    // Indexed by QtMsgType
+    OverloadSettings m_overload_of_type[5];
+    QHash<QByteArray, OverloadSettings> m_overload_of_category;
+
+    // Samplers, indexed by QtMsgType or by category, m_sampling_count
+    //  avoids locking m_sampling_mutex when no sampler is set
+    QMutex m_sampling_mutex;
+    QAtomicInt m_sampling_count;
+    QSharedPointer<QtMessageFilterSampler> m_sampler_of_type[5];
+    QHash<QByteArray, QSharedPointer<QtMessageFilterSampler>> m_sampler_of_category;
+
+    // Messages of each location of the code, it has its own mutexes
+    QtMessageFilterProfiler m_profiler;
+
+    // Counters of QtMessageFilterCore::statistics, indexed by QtMsgType
+    QAtomicInteger<quint64> m_captured[5];
+    QAtomicInteger<qint64> m_last_rendered_id;
+
+    // Messages per second, measured on windows of at least one second
+    QMutex m_rate_mutex;
+    QElapsedTimer m_rate_timer;
+    quint64 m_rate_captured[5];
+    double m_rate[5];
+
+    // Installed again when the instance is released
+    QtMessageHandler m_previous_message_handler;
+
+Q_SIGNALS:
+    void signal_message_captured(QSharedPointer<MessageDetails> messageDetails);
+    void signal_fatal_message(const QString& msg);
+};
+#endif // QTMESSAGEFILTERCORE_H
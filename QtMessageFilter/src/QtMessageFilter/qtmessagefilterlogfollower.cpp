@@ -0,0 +1,202 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#include "qtmessagefilterlogfollower.h"
+#include "qtmessagefiltercore.h"
+
+#include <QFileInfo>
+#include <QDateTime>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+// Line that begins each record of a message, see QtMessageFilterLogReader
+static const QByteArray c_record_begin("\n<<<<<<<<<<<<<<<");
+
+QtMessageFilterLogFollower::QtMessageFilterLogFollower(const QString& fileName, const qint64 backlogBytes, QObject* parent)
+    : QObject(parent),
+      m_file_name(QFileInfo(fileName).absoluteFilePath()),
+      m_backlog_bytes(backlogBytes),
+      m_watcher(),
+      m_tmr_update(),
+      m_file(),
+      m_reader(),
+      m_offset(0),
+      m_identity(),
+      m_resync(false),
+      m_resync_tail()
+{
+    // The directory tells when the file is created, removed or replaced
+    m_watcher.addPath(QFileInfo(m_file_name).absolutePath());
+
+    m_tmr_update.setSingleShot(true);
+    m_tmr_update.setInterval(100);
+
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged,
+            &m_tmr_update, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged,
+            &m_tmr_update, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(&m_tmr_update, &QTimer::timeout,
+            this, &QtMessageFilterLogFollower::update);
+
+    // The first read waits for the event loop, so the signal can be connected before
+    m_tmr_update.start();
+}
+
+QtMessageFilterLogFollower::~QtMessageFilterLogFollower()
+{
+    m_tmr_update.stop();
+}
+
+QString QtMessageFilterLogFollower::fileName() const
+{
+    return m_file_name;
+}
+
+qint64 QtMessageFilterLogFollower::offset() const
+{
+    return m_offset;
+}
+
+int QtMessageFilterLogFollower::errors() const
+{
+    return m_reader.errors();
+}
+
+void QtMessageFilterLogFollower::update()
+{
+    const QByteArray identity = f_identity(m_file_name);
+
+    // What was written on the old file before it was replaced is read first
+    if(m_file.isOpen() && identity != m_identity)
+    {
+        f_read();
+        m_file.close();
+    }
+
+    // Removed, it is read again when it is created
+    if(identity.isEmpty())
+        return;
+
+    f_watch();
+
+    if(!m_file.isOpen())
+        f_open();
+    else if(m_file.size() < m_offset)
+    {
+        // Truncated, the same file is read again from the beginning
+        m_offset = 0;
+        m_reader.reset();
+        m_resync = false;
+        m_resync_tail.clear();
+    }
+
+    if(m_file.isOpen())
+        f_read();
+}
+
+void QtMessageFilterLogFollower::f_open()
+{
+    m_reader.reset();
+    m_resync_tail.clear();
+
+    m_file.setFileName(m_file_name);
+    if(!m_file.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+    {
+        m_identity.clear();
+        return;
+    }
+    m_identity = f_identity(m_file_name);
+
+    // Only the end of a big file, from the first record that begins there
+    m_offset = qMax((qint64)0, m_file.size() - m_backlog_bytes);
+    m_resync = m_offset > 0;
+}
+
+void QtMessageFilterLogFollower::f_read()
+{
+    if(!m_file.seek(m_offset))
+        return;
+
+    for(;;)
+    {
+        QByteArray data = m_file.read(1024*1024);
+        if(data.isEmpty())
+            break;
+        m_offset += data.size();
+
+        if(m_resync)
+        {
+            data.prepend(m_resync_tail);
+            const int begin = data.indexOf(c_record_begin);
+            if(begin < 0)
+            {
+                m_resync_tail = data.right(c_record_begin.size() - 1);
+                continue;
+            }
+
+            data.remove(0, begin + 1);
+            m_resync = false;
+            m_resync_tail.clear();
+        }
+
+        QList<QSharedPointer<MessageDetails>> messages;
+        for(const QtMessageFilterLogReader::Record& k : m_reader.read(data))
+        {
+            if(k.kind == QtMessageFilterLogReader::Record::Message)
+                messages.append(QtMessageFilterLogReader::toMessageDetails(k));
+        }
+
+        if(!messages.isEmpty())
+            Q_EMIT signal_messages(messages);
+    }
+}
+
+void QtMessageFilterLogFollower::f_watch()
+{
+    // A file removed is no longer watched, it is added again when it comes back
+    if(!m_watcher.files().contains(m_file_name))
+        m_watcher.addPath(m_file_name);
+}
+
+QByteArray QtMessageFilterLogFollower::f_identity(const QString& fileName)
+{
+#ifdef Q_OS_UNIX
+    struct stat info;
+    if(::stat(QFile::encodeName(fileName).constData(), &info) != 0)
+        return QByteArray();
+
+    return QByteArray::number((qulonglong)info.st_dev) + ':' + QByteArray::number((qulonglong)info.st_ino);
+#else
+    // Without inodes, a file created again has another birth time
+    const QFileInfo info(fileName);
+    if(!info.exists())
+        return QByteArray();
+
+    return QByteArray::number(info.birthTime().toMSecsSinceEpoch());
+#endif
+}
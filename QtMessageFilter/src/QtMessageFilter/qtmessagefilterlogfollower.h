@@ -0,0 +1,110 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef QTMESSAGEFILTERLOGFOLLOWER_H
+#define QTMESSAGEFILTERLOGFOLLOWER_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QByteArray>
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QSharedPointer>
+
+#include "qtmessagefilterlogreader.h"
+
+struct MessageDetails;
+
+
+///
+/// \brief This class follows a log file written by another process, like "tail -f"
+/// \details The file and its directory are watched with QFileSystemWatcher (inotify on
+/// Linux), when they change only the bytes appended since the last known offset are read
+/// and given to a QtMessageFilterLogReader, which keeps a record written in half until the
+/// rest of it arrives. So each update costs only the new bytes, no matter the size of the
+/// file. The changes are gathered for a short interval before being read, a process that
+/// writes often does not wake the follower on each record.
+///
+/// When the file becomes smaller than the offset (it was truncated) or the path refers to
+/// another file (it was rotated, or removed and created again, like QtMessageFilterLogWriter
+/// does when a new session starts), it is read again from the beginning. A file that does
+/// not exist yet is read when it is created.
+///
+/// Only the last backlogBytes of the file are read when it is opened, from the first record
+/// that begins on them, so following a huge log does not read all of it. The messages are
+/// emitted with QtMessageFilterLogFollower::signal_messages(), on the order they were
+/// written, converted by QtMessageFilterLogReader::toMessageDetails().
+///
+/// It must live on a thread with an event loop.
+///
+class QtMessageFilterLogFollower : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit QtMessageFilterLogFollower(const QString& fileName, const qint64 backlogBytes = 1024*1024,
+                                        QObject* parent = nullptr);
+    ~QtMessageFilterLogFollower();
+
+    QString fileName() const;
+    qint64 offset() const;
+    int errors() const;
+
+public Q_SLOTS:
+    void update();
+
+private:
+
+    void f_open();
+    void f_read();
+    void f_watch();
+    static QByteArray f_identity(const QString& fileName);
+
+    const QString m_file_name;
+    const qint64 m_backlog_bytes;
+
+    QFileSystemWatcher m_watcher;
+    QTimer m_tmr_update;
+
+    QFile m_file;
+    QtMessageFilterLogReader m_reader;
+
+    // Position of the next byte to be read and the file it belongs to
+    qint64 m_offset;
+    QByteArray m_identity;
+
+    // Opened on the middle of the file, the bytes are skipped until the beginning
+    //  of a record, m_resync_tail keeps a marker cut between two reads
+    bool m_resync;
+    QByteArray m_resync_tail;
+
+Q_SIGNALS:
+    void signal_messages(QList<QSharedPointer<MessageDetails>> messages);
+};
+
+#endif // QTMESSAGEFILTERLOGFOLLOWER_H
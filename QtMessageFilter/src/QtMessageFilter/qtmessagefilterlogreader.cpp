@@ -0,0 +1,483 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "qtmessagefilterlogreader.h"
+#include "qtmessagefilterlogwriter.h"
+#include "qtmessagefiltertemplateminer.h"
+#include "qtmessagefiltercore.h"
+#include "qtmessagefilterpattern.h"
+
+#include <QFile>
+#include <QHash>
+#include <QDataStream>
+
+// Markers around the tag (the id of the message) of each record
+static const QByteArray c_begin_marker("<<<<<<<<<<<<<<<");
+static const QByteArray c_end_marker(">>>>>>>>>>>>>>>");
+
+QtMessageFilterLogReader::QtMessageFilterLogReader()
+    : m_buffer(),
+      m_position(0),
+      m_errors(0),
+      m_last_error(),
+      m_has_begin(false),
+      m_has_end(false),
+      m_foreign_pattern(false)
+{
+
+}
+
+QList<QtMessageFilterLogReader::Record> QtMessageFilterLogReader::read(const QByteArray& data)
+{
+    // Release the bytes already parsed before appending the new ones
+    if(m_position > 0)
+    {
+        m_buffer.remove(0, m_position);
+        m_position = 0;
+    }
+    m_buffer.append(data);
+
+    QList<Record> records;
+    for(;;)
+    {
+        Record record = Record();
+        const Result result = f_parse_next(&record);
+
+        if(result == Incomplete)
+            break;
+        if(result == Parsed)
+            records.append(record);
+    }
+    return records;
+}
+
+void QtMessageFilterLogReader::finish()
+{
+    while(m_position < m_buffer.size() && m_buffer.at(m_position) == '\n')
+        m_position++;
+
+    // Nothing else will be read, what is left is a record cut in half
+    if(m_position < m_buffer.size())
+    {
+        m_errors++;
+        m_last_error = QString("The log ends on an incomplete record (%1 bytes)").arg(m_buffer.size() - m_position);
+    }
+
+    m_buffer.clear();
+    m_position = 0;
+}
+
+void QtMessageFilterLogReader::reset()
+{
+    m_buffer.clear();
+    m_position = 0;
+    m_errors = 0;
+    m_last_error.clear();
+    m_has_begin = false;
+    m_has_end = false;
+    m_foreign_pattern = false;
+}
+
+int QtMessageFilterLogReader::errors() const
+{
+    return m_errors;
+}
+
+QString QtMessageFilterLogReader::lastError() const
+{
+    return m_last_error;
+}
+
+bool QtMessageFilterLogReader::hasBegin() const
+{
+    return m_has_begin;
+}
+
+bool QtMessageFilterLogReader::hasEnd() const
+{
+    return m_has_end;
+}
+
+qint64 QtMessageFilterLogReader::pendingBytes() const
+{
+    return m_buffer.size() - m_position;
+}
+
+QList<QtMessageFilterLogReader::Record> QtMessageFilterLogReader::readFile(const QString& fileName, QString* error)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        if(error)
+            *error = file.errorString();
+        return QList<Record>();
+    }
+
+    QtMessageFilterLogReader reader;
+    QList<Record> records;
+    while(!file.atEnd())
+        records.append(reader.read(file.read(1024*1024)));
+    reader.finish();
+
+    if(error)
+        *error = reader.errors() ? reader.lastError() : QString();
+
+    return records;
+}
+
+QList<QtMessageFilterLogReader::Record> QtMessageFilterLogReader::readBinaryFile(const QString& fileName, QString* error)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        if(error)
+            *error = file.errorString();
+        return QList<Record>();
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic = 0, version = 0;
+    qint64 begin = 0;
+    stream >> magic >> version >> begin;
+    if(magic != QtMessageFilterLogWriter::BinaryMagic || version != QtMessageFilterLogWriter::BinaryVersion)
+    {
+        if(error)
+            *error = "It is not a binary log of QtMessageFilter";
+        return QList<Record>();
+    }
+
+    QHash<quint32, QString> strings;
+    QHash<qint32, QByteArray> templates;
+    QList<Record> records;
+
+    // The last record may be incomplete if the log is still being written
+    while(!stream.atEnd() && stream.status() == QDataStream::Ok)
+    {
+        quint8 kind = 0;
+        stream >> kind;
+
+        if(kind == QtMessageFilterLogWriter::BinaryString)
+        {
+            quint32 id = 0;
+            QByteArray str;
+            stream >> id >> str;
+            strings.insert(id, QString::fromUtf8(str));
+        }
+        else if(kind == QtMessageFilterLogWriter::BinaryTemplate)
+        {
+            qint32 id = 0;
+            QByteArray messageTemplate;
+            stream >> id >> messageTemplate;
+            templates.insert(id, messageTemplate);
+        }
+        else if(kind == QtMessageFilterLogWriter::BinaryMessage)
+        {
+            quint64 id = 0, threadId = 0, sampledOut = 0;
+            quint8 type = 0;
+            qint64 time = 0;
+            quint32 fileNameId = 0, functionId = 0, categoryId = 0, threadNameId = 0;
+            qint32 line = 0, templateId = -1;
+
+            stream >> id >> type >> time >> fileNameId >> line >> functionId >> categoryId >>
+                      threadId >> threadNameId >> sampledOut >> templateId;
+
+            QByteArray message;
+            if(templateId >= 0)
+            {
+                quint32 count = 0;
+                stream >> count;
+
+                QList<QByteArray> parameters;
+                for(quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++)
+                {
+                    QByteArray parameter;
+                    stream >> parameter;
+                    parameters.append(parameter);
+                }
+                message = QtMessageFilterTemplateMiner::reconstruct(templates.value(templateId), parameters);
+            }
+            else
+                stream >> message;
+
+            if(stream.status() != QDataStream::Ok)
+                break;
+
+            Record record = Record();
+            record.kind = Record::Message;
+            record.type = (QtMsgType)type;
+            record.id = (ulong)id;
+            record.fileName = strings.value(fileNameId);
+            record.line = line;
+            record.function = strings.value(functionId);
+            record.category = strings.value(categoryId);
+            record.threadName = strings.value(threadNameId);
+            record.threadId = (quintptr)threadId;
+            record.dateTime = QDateTime::fromMSecsSinceEpoch(time);
+            record.sampledOut = sampledOut;
+            record.templateId = templateId;
+            record.message = QString::fromUtf8(message);
+            records.append(record);
+        }
+        else
+        {
+            if(error)
+                *error = QString("Unknown record %1 on the binary log").arg(kind);
+            return records;
+        }
+    }
+
+    if(error)
+        *error = stream.status() == QDataStream::Ok ? QString() : QString("The binary log ends on an incomplete record");
+
+    return records;
+}
+
+QSharedPointer<MessageDetails> QtMessageFilterLogReader::toMessageDetails(const Record& record)
+{
+    return QSharedPointer<MessageDetails>(new MessageDetails(record.type, record.line, record.fileName.toUtf8(),
+                                                             record.function.toUtf8(), record.category.toUtf8(),
+                                                             record.message.toUtf8(), record.id, record.dateTime,
+                                                             record.threadId, record.threadName,
+                                                             -1, 0, record.sampledOut));
+}
+
+QtMessageFilterLogReader::Result QtMessageFilterLogReader::f_parse_next(Record* record)
+{
+    for(;;)
+    {
+        while(m_position < m_buffer.size() && m_buffer.at(m_position) == '\n')
+            m_position++;
+
+        // Nothing is written after the end of the log
+        if(m_position >= m_buffer.size() || m_has_end)
+        {
+            m_position = m_buffer.size();
+            return Incomplete;
+        }
+
+        const int lineEnd = m_buffer.indexOf('\n', m_position);
+        const QByteArray head = QByteArray::fromRawData(m_buffer.constData() + m_position,
+                                                        (lineEnd < 0 ? m_buffer.size() : lineEnd) - m_position);
+
+        if(head.startsWith("\\END "))
+        {
+            m_has_end = true;
+            continue;
+        }
+
+        if(lineEnd < 0)
+            return Incomplete;
+
+        if(head.startsWith("\\BEGIN "))
+        {
+            m_has_begin = true;
+            m_position = lineEnd + 1;
+            continue;
+        }
+
+        if(head.startsWith("\\PATTERN "))
+        {
+            const QString pattern = QString::fromUtf8(QByteArray::fromPercentEncoding(head.mid(9)));
+            m_foreign_pattern = pattern != QtMessageFilterPattern::defaultPattern();
+            if(m_foreign_pattern)
+            {
+                m_errors++;
+                m_last_error = QString("The records of the pattern \"%1\" can not be read").arg(pattern);
+            }
+            m_position = lineEnd + 1;
+            continue;
+        }
+
+        // Skipped line by line, until the default pattern is back
+        if(m_foreign_pattern)
+        {
+            m_position = lineEnd + 1;
+            continue;
+        }
+
+        if(!head.startsWith(c_begin_marker) || !head.endsWith(c_begin_marker) ||
+           head.size() <= 2*c_begin_marker.size())
+        {
+            f_skip_invalid("Unexpected content outside of a record");
+            continue;
+        }
+
+        const QByteArray tag = head.mid(c_begin_marker.size(), head.size() - 2*c_begin_marker.size());
+
+        // The body ends on the line break before the end marker with the same tag
+        const QByteArray endMarker = '\n' + c_end_marker + tag + c_end_marker + '\n';
+        const int endPosition = m_buffer.indexOf(endMarker, lineEnd);
+        if(endPosition < 0)
+            return Incomplete;
+
+        const QByteArray body = m_buffer.mid(lineEnd + 1, endPosition + 1 - (lineEnd + 1));
+        m_position = endPosition + endMarker.size();
+
+        if(!f_parse_body(tag, body, record))
+        {
+            m_errors++;
+            m_last_error = QString("The record %1 is malformed").arg(QString::fromUtf8(tag));
+            continue;
+        }
+
+        return Parsed;
+    }
+}
+
+bool QtMessageFilterLogReader::f_parse_body(const QByteArray& tag, const QByteArray& body, Record* record)
+{
+    bool isMessage = false;
+    bool ok = true;
+
+    record->templateId = -1;
+
+    if(tag == "dropped")
+        record->kind = Record::Dropped;
+    else if(tag == "statistics")
+        record->kind = Record::Statistics;
+    else if(tag == "sampled_out")
+        record->kind = Record::SampledOut;
+    else
+    {
+        record->kind = Record::Message;
+        record->id = tag.toULong(&ok);
+        if(!ok)
+            return false;
+    }
+
+    int position = 0;
+    while(position < body.size() && body.at(position) == '\\')
+    {
+        const int lineEnd = body.indexOf('\n', position);
+        if(lineEnd < 0)
+            return false;
+
+        const QByteArray key = body.mid(position + 1, lineEnd - position - 1);
+
+        // The header of the message ("\debug\id<id>: "), the message goes until the end
+        if(key.endsWith(": "))
+        {
+            const int separator = key.indexOf("\\id");
+            if(separator < 0 || record->kind != Record::Message ||
+               key.mid(separator + 3, key.size() - separator - 5) != tag)
+            {
+                return false;
+            }
+
+            const QByteArray typeName = key.left(separator);
+            if(typeName == "debug")
+                record->type = QtDebugMsg;
+            else if(typeName == "info")
+                record->type = QtInfoMsg;
+            else if(typeName == "warning")
+                record->type = QtWarningMsg;
+            else if(typeName == "critical")
+                record->type = QtCriticalMsg;
+            else if(typeName == "fatal")
+                record->type = QtFatalMsg;
+            else
+                return false;
+
+            record->message = QString::fromUtf8(body.constData() + lineEnd + 1, body.size() - 1 - (lineEnd + 1));
+            isMessage = true;
+            break;
+        }
+
+        if(!key.endsWith(':'))
+            return false;
+
+        // Each value is followed by an empty line, but the last one
+        int valueEnd = body.indexOf("\n\n", lineEnd + 1);
+        if(valueEnd < 0)
+            valueEnd = body.size() - 1;
+        const QByteArray value = body.mid(lineEnd + 1, valueEnd - (lineEnd + 1));
+        position = valueEnd + 2;
+
+        if(key == "origin:")
+        {
+            const int space = value.lastIndexOf(' ');
+            record->fileName = QString::fromUtf8(value.left(qMax(0, space)));
+            record->line = value.mid(space + 1).toInt();
+        }
+        else if(key == "function_call:")
+            record->function = QString::fromUtf8(value);
+        else if(key == "category:")
+            record->category = QString::fromUtf8(value);
+        else if(key == "thread:")
+        {
+            const int space = value.lastIndexOf(' ');
+            record->threadName = QString::fromUtf8(value.left(qMax(0, space)));
+            record->threadId = (quintptr)value.mid(space + 1).toULongLong(&ok, 16);
+        }
+        else if(key == "time_date:")
+            record->dateTime = QDateTime::fromString(QString::fromUtf8(value), Qt::ISODateWithMs);
+        else if(key == "sampled:")
+            record->sampledOut = value.mid(value.lastIndexOf(' ') + 1).toULongLong() - 1;
+        else if(key == "stack:")
+            record->stack = QString::fromUtf8(value);
+        else if(key == "statistics:" || key == "sampled_out:")
+            record->message = QString::fromUtf8(value);
+        else if(key == "dropped:")
+        {
+            for(const QByteArray& k : value.split('\n'))
+            {
+                const int space = k.indexOf(' ');
+                const QByteArray typeName = k.left(space);
+                const quint64 count = k.mid(space + 1).toULongLong();
+
+                if(typeName == "debug")
+                    record->dropped[QtDebugMsg] = count;
+                else if(typeName == "info")
+                    record->dropped[QtInfoMsg] = count;
+                else if(typeName == "warning")
+                    record->dropped[QtWarningMsg] = count;
+                else if(typeName == "critical")
+                    record->dropped[QtCriticalMsg] = count;
+            }
+        }
+        // Unknown fields are ignored, they may come from a newer version
+    }
+
+    return record->kind != Record::Message || isMessage;
+}
+
+void QtMessageFilterLogReader::f_skip_invalid(const QString& reason)
+{
+    m_errors++;
+    m_last_error = reason;
+
+    // Continue on the next line that begins a record
+    const int next = m_buffer.indexOf('\n' + c_begin_marker, m_position);
+    if(next >= 0)
+        m_position = next + 1;
+    else
+    {
+        // Keep the last line, it may be the beginning of a record not complete yet
+        const int lastLine = m_buffer.lastIndexOf('\n');
+        m_position = qMax(m_position + 1, lastLine + 1);
+    }
+}
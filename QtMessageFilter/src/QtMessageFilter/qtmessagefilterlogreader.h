@@ -0,0 +1,149 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef QTMESSAGEFILTERLOGREADER_H
+#define QTMESSAGEFILTERLOGREADER_H
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+#include <QDateTime>
+#include <QSharedPointer>
+
+struct MessageDetails;
+
+
+///
+/// \brief This class parses the log file written by QtMessageFilterCore
+/// \details The content of the log file is given to QtMessageFilterLogReader::read()
+/// in pieces of any size, as they are read from the disk, and it returns the records
+/// completed by each piece. The beginning of a record that is not complete yet is kept
+/// until the next piece, that way a log file that is still being written can also be
+/// read.
+///
+/// Each record of a message is returned with its details, the records written by the
+/// log writer itself (like the count of dropped messages) are returned with their own
+/// kind. The bytes that do not belong to a valid record are skipped until the beginning
+/// of the next record and counted by QtMessageFilterLogReader::errors(), a log file
+/// written correctly has no error.
+///
+/// Only the records of the default pattern of QtMessageFilterPattern can be parsed.
+/// After the header of another pattern ("\PATTERN", written when QT_MESSAGE_PATTERN
+/// is set or by QtMessageFilterCore::setOutputPattern()), the lines are skipped until
+/// the header of the default pattern, with a single error telling the pattern.
+///
+/// QtMessageFilterLogReader::readFile() reads a whole file at once and
+/// QtMessageFilterLogReader::readBinaryFile() reads a whole binary log (see
+/// QtMessageFilterLogWriter::BinaryRecord), rebuilding each message from its
+/// template and parameters. QtMessageFilterLogReader::toMessageDetails() converts
+/// the record of a message to the MessageDetails of QtMessageFilterCore.
+///
+class QtMessageFilterLogReader
+{
+public:
+
+    struct Record
+    {
+        enum Kind
+        {
+            Message,
+            Dropped,
+            Statistics,
+            SampledOut
+        };
+
+        Kind kind;
+
+        QtMsgType type;
+        ulong id;
+
+        QString fileName;
+        int line;
+        QString function;
+        QString category;
+
+        QString threadName;
+        quintptr threadId;
+
+        QDateTime dateTime;
+
+        quint64 sampledOut;
+
+        // Symbolized stack of critical and fatal messages, one frame per line
+        QString stack;
+
+        // Only known on the binary log, -1 otherwise
+        int templateId;
+
+        // For Statistics, the counters as they were written, for SampledOut
+        //  the locations as "<file> <line> <count>", one per line
+        QString message;
+
+        // Only for Dropped, indexed by QtMsgType
+        quint64 dropped[5];
+    };
+
+    QtMessageFilterLogReader();
+
+    QList<Record> read(const QByteArray& data);
+    void finish();
+    void reset();
+
+    int errors() const;
+    QString lastError() const;
+    bool hasBegin() const;
+    bool hasEnd() const;
+    qint64 pendingBytes() const;
+
+    static QList<Record> readFile(const QString& fileName, QString* error = nullptr);
+    static QList<Record> readBinaryFile(const QString& fileName, QString* error = nullptr);
+    static QSharedPointer<MessageDetails> toMessageDetails(const Record& record);
+
+private:
+
+    enum Result
+    {
+        Parsed,
+        Incomplete,
+        Invalid
+    };
+
+    Result f_parse_next(Record* record);
+    bool f_parse_body(const QByteArray& tag, const QByteArray& body, Record* record);
+    void f_skip_invalid(const QString& reason);
+
+    QByteArray m_buffer;
+    int m_position;
+
+    int m_errors;
+    QString m_last_error;
+
+    bool m_has_begin;
+    bool m_has_end;
+
+    // After the header of a pattern other than the default one
+    bool m_foreign_pattern;
+};
+
+#endif // QTMESSAGEFILTERLOGREADER_H
@@ -0,0 +1,596 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "qtmessagefilterlogwriter.h"
+#include "qtmessagefiltercore.h"
+#include "qtmessagefiltertemplateminer.h"
+
+#include <QFile>
+#include <QElapsedTimer>
+
+#include <climits>
+#include <cstdio>
+#include <algorithm>
+
+QtMessageFilterLogWriter::QtMessageFilterLogWriter(const QString& fileName, QObject* parent)
+    : QThread(parent),
+      m_file_name(fileName),
+      m_begin_date_time(QDateTime::currentDateTime()),
+      m_mutex(),
+      m_wc_pending(),
+      m_wc_written(),
+      m_wc_space(),
+      m_pending(),
+      m_reordered(),
+      m_skipped_sequences(),
+      m_next_sequence(0),
+      m_capacity(65536),
+      m_queue_depth(0),
+      m_count_queued(0),
+      m_count_written(0),
+      m_bytes_written(0),
+      m_records_written(0),
+      m_flush_latency(),
+      m_dropped(),
+      m_dropped_unreported{0, 0, 0, 0, 0},
+      m_statistics_interval(0),
+      m_statistics_record(),
+      m_template_miner(nullptr),
+      m_mined_callback(),
+      m_binary_file_name(),
+      m_binary_strings(),
+      m_stop(false)
+{
+    this->setObjectName("QtMessageFilterLogWriter");
+}
+
+QtMessageFilterLogWriter::~QtMessageFilterLogWriter()
+{
+    stop();
+    this->wait();
+}
+
+bool QtMessageFilterLogWriter::write(const QByteArray& record, const QtMsgType type,
+                                     const OverloadPolicy policy, const int timeout,
+                                     const QSharedPointer<MessageDetails>& details,
+                                     const QByteArray& fullMessage, const int stackOffset, const qint64 sequence)
+{
+    QMutexLocker locker(&m_mutex);
+
+    const int capacity = m_capacity.loadAcquire();
+
+    // The writer thread can not wait for itself
+    bool accepted = true;
+    if(type != QtFatalMsg && QThread::currentThread() != this)
+    {
+        switch(policy)
+        {
+            case Block:
+                accepted = f_wait_for_space(capacity, timeout, sequence);
+                break;
+
+            case DropNewest:
+                accepted = f_queued() < capacity;
+                break;
+
+            case DropOldest:
+                accepted = f_drop_oldest(capacity);
+                if(!accepted && type == QtCriticalMsg)
+                    accepted = f_wait_for_space(capacity, -1, sequence);
+                break;
+
+            case ShedByType:
+            {
+                int threshold = capacity;
+                if(type == QtDebugMsg)
+                    threshold = capacity/2;
+                else if(type == QtInfoMsg)
+                    threshold = 3*capacity/4;
+
+                accepted = type == QtCriticalMsg || f_queued() < threshold;
+                if(accepted)
+                    f_wait_for_space(capacity, -1, sequence);
+            }break;
+        }
+    }
+
+    if(!accepted)
+    {
+        f_count_dropped(type);
+
+        // The records after this one do not wait for it
+        if(sequence >= 0)
+        {
+            m_skipped_sequences.insert((quint64)sequence);
+            f_release_in_order();
+        }
+        return false;
+    }
+
+    const Record pending{record, type, details, fullMessage, stackOffset};
+    if(sequence >= 0)
+    {
+        m_reordered.insert((quint64)sequence, pending);
+        f_release_in_order();
+    }
+    else
+    {
+        m_pending.enqueue(pending);
+        m_queue_depth.storeRelease(f_queued());
+        m_wc_pending.wakeOne();
+    }
+    m_count_queued++;
+
+    return true;
+}
+
+void QtMessageFilterLogWriter::flush()
+{
+    // The writer thread can not wait for itself
+    if(QThread::currentThread() == this)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+
+    const quint64 target = m_count_queued;
+    while(m_count_written < target && this->isRunning())
+        m_wc_written.wait(&m_mutex, 100);
+}
+
+void QtMessageFilterLogWriter::stop()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_stop = true;
+    m_wc_pending.wakeOne();
+    m_wc_space.wakeAll();
+}
+
+void QtMessageFilterLogWriter::setCapacity(const int capacity)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_capacity.storeRelease(qMax(1, capacity));
+    m_wc_space.wakeAll();
+}
+
+quint64 QtMessageFilterLogWriter::dropped(const QtMsgType type) const
+{
+    return m_dropped[type].loadAcquire();
+}
+
+QtMessageFilterLogWriter::Statistics QtMessageFilterLogWriter::statistics() const
+{
+    // Only atomics are read, the writer is never waited
+    Statistics statistics;
+
+    statistics.bytesWritten = m_bytes_written.loadAcquire();
+    statistics.recordsWritten = m_records_written.loadAcquire();
+    statistics.queueDepth = m_queue_depth.loadAcquire();
+    statistics.queueCapacity = m_capacity.loadAcquire();
+
+    for(int i = 0; i < 5; i++)
+        statistics.dropped[i] = m_dropped[i].loadAcquire();
+
+    for(int i = 0; i < FlushLatencyBuckets; i++)
+        statistics.flushLatency[i] = m_flush_latency[i].loadAcquire();
+
+    return statistics;
+}
+
+void QtMessageFilterLogWriter::setStatisticsRecord(const int interval, std::function<QByteArray(const Statistics&)> record)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_statistics_interval = record ? qMax(0, interval) : 0;
+    m_statistics_record = record;
+    m_wc_pending.wakeOne();
+}
+
+void QtMessageFilterLogWriter::setTemplateMiner(QtMessageFilterTemplateMiner* miner)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_template_miner = miner;
+}
+
+void QtMessageFilterLogWriter::setMinedCallback(std::function<void(const QSharedPointer<MessageDetails>&)> callback)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_mined_callback = callback;
+}
+
+void QtMessageFilterLogWriter::setBinaryLog(const QString& fileName)
+{
+    // It is opened (or closed) by the writer thread on its next records
+    QMutexLocker locker(&m_mutex);
+
+    m_binary_file_name = fileName;
+    m_wc_pending.wakeOne();
+}
+
+bool QtMessageFilterLogWriter::f_wait_for_space(const int size, const int timeout, const qint64 sequence)
+{
+    // Must be called with m_mutex locked
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    // The records waiting for this one can only be written after it, so they
+    //  do not count for it (otherwise it would wait for itself)
+    auto full = [this, size, sequence]
+    {
+        return (sequence < 0 || (quint64)sequence == m_next_sequence ? m_pending.size() : f_queued()) >= size;
+    };
+
+    while(full() && !m_stop)
+    {
+        const ulong remaining = timeout < 0 ? ULONG_MAX : (ulong)qMax<qint64>(0, timeout - elapsed.elapsed());
+        if(remaining == 0 || !m_wc_space.wait(&m_mutex, remaining))
+            return !full();
+    }
+    return true;
+}
+
+int QtMessageFilterLogWriter::f_queued() const
+{
+    // Must be called with m_mutex locked
+    return m_pending.size() + m_reordered.size();
+}
+
+bool QtMessageFilterLogWriter::f_drop_oldest(const int capacity)
+{
+    // Must be called with m_mutex locked
+
+    // Critical and fatal records are never the victims
+    auto droppable = [](const Record& record){ return record.type != QtCriticalMsg && record.type != QtFatalMsg; };
+
+    bool dropped = false;
+    while(f_queued() >= capacity)
+    {
+        // The queued ones are older than the ones waiting for their sequence
+        auto pending = std::find_if(m_pending.begin(), m_pending.end(), droppable);
+        if(pending != m_pending.end())
+        {
+            f_count_dropped(pending->type);
+            m_pending.erase(pending);
+        }
+        else
+        {
+            auto reordered = std::find_if(m_reordered.begin(), m_reordered.end(), droppable);
+            if(reordered == m_reordered.end())
+                break;
+
+            // The records after it do not wait for it
+            f_count_dropped(reordered->type);
+            m_skipped_sequences.insert(reordered.key());
+            m_reordered.erase(reordered);
+        }
+
+        // It will not be written, but it is not waited by flush anymore
+        m_count_written++;
+        dropped = true;
+    }
+
+    if(dropped)
+    {
+        f_release_in_order();
+        m_wc_written.wakeAll();
+    }
+
+    return f_queued() < capacity;
+}
+
+void QtMessageFilterLogWriter::f_release_in_order()
+{
+    // Must be called with m_mutex locked
+    const int pending = m_pending.size();
+    for(;;)
+    {
+        if(m_skipped_sequences.remove(m_next_sequence))
+        {
+            m_next_sequence++;
+            continue;
+        }
+
+        auto i = m_reordered.find(m_next_sequence);
+        if(i == m_reordered.end())
+            break;
+
+        m_pending.enqueue(i.value());
+        m_reordered.erase(i);
+        m_next_sequence++;
+    }
+    m_queue_depth.storeRelease(f_queued());
+
+    if(m_pending.size() > pending)
+        m_wc_pending.wakeOne();
+
+    // The next record in order may be waiting for space
+    m_wc_space.wakeAll();
+}
+
+void QtMessageFilterLogWriter::f_count_dropped(const QtMsgType type)
+{
+    // Must be called with m_mutex locked
+    m_dropped[type].fetchAndAddRelaxed(1);
+    m_dropped_unreported[type]++;
+}
+
+QByteArray QtMessageFilterLogWriter::f_dropped_record()
+{
+    // Must be called with m_mutex locked
+    if(!m_dropped_unreported[QtDebugMsg] && !m_dropped_unreported[QtInfoMsg] &&
+       !m_dropped_unreported[QtWarningMsg] && !m_dropped_unreported[QtCriticalMsg])
+    {
+        return QByteArray();
+    }
+
+    const QByteArray record =
+            "<<<<<<<<<<<<<<<dropped<<<<<<<<<<<<<<<\n"
+            "\\time_date:\n" +
+            QDateTime::currentDateTime().toString(Qt::ISODateWithMs).toUtf8() + "\n\n"
+            "\\dropped:\n"
+            "debug " + QByteArray::number(m_dropped_unreported[QtDebugMsg]) + "\n"
+            "info " + QByteArray::number(m_dropped_unreported[QtInfoMsg]) + "\n"
+            "warning " + QByteArray::number(m_dropped_unreported[QtWarningMsg]) + "\n"
+            "critical " + QByteArray::number(m_dropped_unreported[QtCriticalMsg]) + "\n"
+            ">>>>>>>>>>>>>>>dropped>>>>>>>>>>>>>>>\n";
+
+    for(quint64& k : m_dropped_unreported)
+        k = 0;
+
+    return record;
+}
+
+void QtMessageFilterLogWriter::f_count_flush_latency(const qint64 microseconds)
+{
+    // Bucket of floor(log2(microseconds))
+    int bucket = 0;
+    while(bucket < FlushLatencyBuckets - 1 && (microseconds >> (bucket + 1)) > 0)
+        bucket++;
+
+    m_flush_latency[bucket].fetchAndAddRelaxed(1);
+}
+
+QByteArray QtMessageFilterLogWriter::f_mine(const Record& record, QtMessageFilterTemplateMiner* miner, const bool binary)
+{
+    const MessageDetails& details = *record.details;
+    const QByteArray message = record.fullMessage.isNull() ? details.messageUtf8 : record.fullMessage;
+
+    const QtMessageFilterTemplateMiner::Result result = miner->mine(message);
+    details.templateId.storeRelease(result.templateId);
+
+    if(!binary)
+        return QByteArray();
+
+    QByteArray binaryRecord;
+    QDataStream stream(&binaryRecord, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_6);
+
+    // The strings and the template are written before the message that uses them
+    const quint32 fileName = f_binary_string(stream, details.fileNameUtf8);
+    const quint32 function = f_binary_string(stream, details.functionUtf8);
+    const quint32 category = f_binary_string(stream, details.categoryUtf8);
+    const quint32 threadName = f_binary_string(stream, details.threadName.toUtf8());
+
+    if(result.templateChanged)
+        stream << (quint8)BinaryTemplate << (qint32)result.templateId << miner->templateOf(result.templateId);
+
+    stream << (quint8)BinaryMessage << (quint64)details.id << (quint8)details.type <<
+              (qint64)details.dateTime.toMSecsSinceEpoch() << fileName << (qint32)details.line <<
+              function << category << (quint64)details.threadId << threadName <<
+              (quint64)details.sampledOut << (qint32)result.templateId;
+
+    if(result.templateId >= 0)
+    {
+        stream << (quint32)result.parameters.size();
+        for(const QByteArray& k : result.parameters)
+            stream << k;
+    }
+    else
+        stream << message;
+
+    return binaryRecord;
+}
+
+quint32 QtMessageFilterLogWriter::f_binary_string(QDataStream& stream, const QByteArray& utf8)
+{
+    auto i = m_binary_strings.constFind(utf8);
+    if(i != m_binary_strings.constEnd())
+        return i.value();
+
+    const quint32 id = (quint32)m_binary_strings.size();
+    m_binary_strings.insert(utf8, id);
+    stream << (quint8)BinaryString << id << utf8;
+    return id;
+}
+
+void QtMessageFilterLogWriter::run()
+{
+    // Remove last log file, create a new one and let it be opened
+    QFile::remove(m_file_name);
+
+    QFile logFile(m_file_name);
+
+    // Without the log file, the records are still taken from the queue (so flush()
+    //  and the producers are not blocked) but discarded. Writing on a closed device
+    //  would generate a warning, which would be queued here again, and so on
+    const bool logFileOpen = logFile.open(QIODevice::WriteOnly);
+    if(!logFileOpen)
+    {
+        fprintf(stderr, "QtMessageFilterLogWriter: could not open the log file %s (%s), its records will be discarded\n",
+                qPrintable(m_file_name), qPrintable(logFile.errorString()));
+    }
+
+    auto writeLog = [&logFile, logFileOpen](const char* data, const qint64 size) -> qint64
+    {
+        return logFileOpen ? logFile.write(data, size) : 0;
+    };
+
+    // Log File Begin
+    const QByteArray begin = "\\BEGIN " + m_begin_date_time.toString(Qt::ISODateWithMs).toUtf8() + "\n\n\n";
+    writeLog(begin.constData(), begin.size());
+
+    QQueue<Record> records;
+    bool stop = false;
+
+    QFile binaryFile;
+    QtMessageFilterTemplateMiner* miner = nullptr;
+    std::function<void(const QSharedPointer<MessageDetails>&)> mined;
+
+    QElapsedTimer statisticsTimer;
+    statisticsTimer.start();
+
+    // Must be called with m_mutex locked
+    auto statisticsDue = [this, &statisticsTimer]
+    {
+        return m_statistics_interval > 0 && statisticsTimer.elapsed() >= m_statistics_interval;
+    };
+
+    while(!stop)
+    {
+        std::function<QByteArray(const Statistics&)> statisticsRecord;
+        {
+            QMutexLocker locker(&m_mutex);
+
+            while(m_pending.isEmpty() && !m_stop && !statisticsDue())
+            {
+                m_wc_pending.wait(&m_mutex, m_statistics_interval > 0 ?
+                                      (ulong)qMax<qint64>(1, m_statistics_interval - statisticsTimer.elapsed()) :
+                                      ULONG_MAX);
+            }
+
+            records.swap(m_pending);
+            m_queue_depth.storeRelease(f_queued());
+            stop = m_stop;
+
+            miner = m_template_miner;
+            mined = m_mined_callback;
+
+            // The binary log was enabled, disabled or changed
+            if(m_binary_file_name != binaryFile.fileName() || m_binary_file_name.isEmpty() != !binaryFile.isOpen())
+            {
+                binaryFile.close();
+                binaryFile.setFileName(QString());
+                m_binary_strings.clear();
+
+                if(!m_binary_file_name.isEmpty())
+                {
+                    QFile::remove(m_binary_file_name);
+                    binaryFile.setFileName(m_binary_file_name);
+                    if(binaryFile.open(QIODevice::WriteOnly))
+                    {
+                        QDataStream stream(&binaryFile);
+                        stream.setVersion(QDataStream::Qt_5_6);
+                        stream << (quint32)BinaryMagic << (quint32)BinaryVersion << (qint64)m_begin_date_time.toMSecsSinceEpoch();
+                    }
+                }
+            }
+
+            if(statisticsDue())
+            {
+                statisticsRecord = m_statistics_record;
+                statisticsTimer.restart();
+            }
+
+            // The producers blocked by a full queue can continue
+            m_wc_space.wakeAll();
+        }
+
+        QElapsedTimer latency;
+        latency.start();
+
+        const quint64 count = records.size();
+        qint64 bytes = 0;
+        while(!records.isEmpty())
+        {
+            const Record record = records.dequeue();
+
+            if(record.details && record.stackOffset >= 0 && record.stackOffset <= record.data.size())
+            {
+                // Symbolized only now, out of the thread of the message
+                const QByteArray stack = QtMessageFilterStackTrace::toText(record.details->stack).toUtf8();
+                bytes += writeLog(record.data.constData(), record.stackOffset);
+                bytes += writeLog(stack.constData(), stack.size());
+                bytes += writeLog(record.data.constData() + record.stackOffset, record.data.size() - record.stackOffset);
+            }
+            else
+                bytes += writeLog(record.data.constData(), record.data.size());
+
+            if(miner && record.details)
+            {
+                const QByteArray binaryRecord = f_mine(record, miner, binaryFile.isOpen());
+                if(!binaryRecord.isEmpty())
+                    binaryFile.write(binaryRecord);
+
+                if(mined)
+                    mined(record.details);
+            }
+        }
+
+        QByteArray droppedRecord;
+        {
+            QMutexLocker locker(&m_mutex);
+            droppedRecord = f_dropped_record();
+        }
+        if(!droppedRecord.isEmpty())
+            bytes += writeLog(droppedRecord.constData(), droppedRecord.size());
+
+        // Built without m_mutex, it may read the counters of the owner
+        if(statisticsRecord)
+        {
+            const QByteArray statisticsData = statisticsRecord(statistics());
+            bytes += writeLog(statisticsData.constData(), statisticsData.size());
+        }
+
+        if(logFileOpen)
+            logFile.flush();
+        if(binaryFile.isOpen())
+            binaryFile.flush();
+
+        m_bytes_written.fetchAndAddRelaxed((quint64)qMax<qint64>(0, bytes));
+        if(logFileOpen)
+            m_records_written.fetchAndAddRelaxed(count);
+        if(count > 0 && logFileOpen)
+            f_count_flush_latency(latency.nsecsElapsed()/1000);
+
+        {
+            QMutexLocker locker(&m_mutex);
+
+            m_count_written += count;
+            m_wc_written.wakeAll();
+
+            // Records queued while the last ones were written
+            if(stop && !m_pending.isEmpty())
+                stop = false;
+        }
+    }
+
+    // Log File End
+    const QByteArray end = "\n\n\n\\END " + QDateTime::currentDateTime().toString(Qt::ISODateWithMs).toUtf8();
+    writeLog(end.constData(), end.size());
+    logFile.close();
+}
@@ -0,0 +1,255 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef QTMESSAGEFILTERLOGWRITER_H
+#define QTMESSAGEFILTERLOGWRITER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QByteArray>
+#include <QDateTime>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QDataStream>
+
+#include <functional>
+
+struct MessageDetails;
+class QtMessageFilterTemplateMiner;
+
+
+///
+/// \brief This thread writes the log file of QtMessageFilterCore
+/// \details The log file is removed, created and written only on this
+/// thread, so the threads that generate the messages only have to format
+/// the record and append it to a queue with
+/// QtMessageFilterLogWriter::write(). The records are written on the
+/// order they were queued. The line "\BEGIN <date>" is written when the
+/// thread starts and "\END <date>" when it is stopped, after all the
+/// records queued before.
+///
+/// QtMessageFilterLogWriter::flush() blocks until every record queued
+/// before the call was written on the disk, it is used before the
+/// application is terminated by a fatal message.
+///
+/// When the log file can not be opened, the failure is reported once on stderr and
+/// the records are still taken from the queue, but discarded.
+///
+/// The queue holds at most QtMessageFilterLogWriter::setCapacity() records,
+/// when it is full the record is treated according to its OverloadPolicy:
+/// * Block: the caller waits for space, up to the timeout (in milliseconds,
+/// negative waits forever), then the new record is dropped;
+/// * DropNewest: the new record is dropped;
+/// * DropOldest: the oldest queued record that is not critical or fatal is dropped
+/// to make space (even if it waits aside for its sequence), when there is none the
+/// new record is dropped (a new critical record waits for space instead);
+/// * ShedByType: debug records are dropped when the queue is half full, info
+/// records when it is 3/4 full, warning records when it is full and critical
+/// records are never dropped, the caller waits for space instead.
+///
+/// The records are written on the order of their sequence (given to
+/// QtMessageFilterLogWriter::write() by QtMessageFilterCore, taken under its mutex),
+/// so the producers can queue them without holding their own mutex. A record that
+/// arrives before the ones of the previous sequences waits aside until they are
+/// queued or dropped, a record without sequence (-1) is queued right away.
+///
+/// Fatal records and records generated on the writer thread itself are always
+/// queued. The count of dropped records of each type is written on the log
+/// file as a "\dropped:" record after the records that were being written
+/// when they were dropped.
+///
+/// The messages are also mined here, by a QtMessageFilterTemplateMiner, so the
+/// threads that generate them never pay for it: the template of each message is
+/// stored on MessageDetails::templateId once it is written. When a binary log is
+/// set with QtMessageFilterLogWriter::setBinaryLog(), each message is also written
+/// there with only the id of its template and its parameters (see BinaryRecord).
+/// The callback given to QtMessageFilterLogWriter::setMinedCallback() is called on
+/// the writer thread after each message is mined, without any lock of the writer.
+///
+/// The stack of a critical or fatal message (MessageDetails::stack) is symbolized
+/// here too, its text is inserted on the record at the position given to
+/// QtMessageFilterLogWriter::write() (the %{stack} of QtMessageFilterPattern).
+///
+/// The counters of the writer (bytes written, depth of the queue, dropped
+/// records and the latency of each flush of the log file) are atomics, so
+/// QtMessageFilterLogWriter::statistics() can be called from any thread
+/// without waiting for the writer. A record built by the owner of the writer
+/// from them can be written periodically with
+/// QtMessageFilterLogWriter::setStatisticsRecord().
+///
+class QtMessageFilterLogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+
+    enum OverloadPolicy
+    {
+        Block,
+        DropNewest,
+        DropOldest,
+        ShedByType
+    };
+
+    static const int FlushLatencyBuckets = 20;
+
+    // The binary log begins with BinaryMagic and BinaryVersion (quint32), then the
+    //  time it was created (qint64, milliseconds since epoch). Each record begins
+    //  with its kind (quint8), everything is written with QDataStream::Qt_5_6:
+    //  * BinaryString: id (quint32) and the string (QByteArray), the strings are
+    //  written once and referenced by their id;
+    //  * BinaryTemplate: id (qint32) and the template (QByteArray), written again
+    //  when the template gets new parameters;
+    //  * BinaryMessage: id (quint64), type (quint8), time (qint64, milliseconds since
+    //  epoch), file (string id), line (qint32), function (string id), category (string
+    //  id), thread (quint64), name of the thread (string id), sampled out (quint64)
+    //  and template (qint32), followed by the count of parameters (quint32) and the
+    //  parameters (QByteArray) or, without template (-1), the message (QByteArray).
+    enum BinaryRecord
+    {
+        BinaryString = 1,
+        BinaryTemplate = 2,
+        BinaryMessage = 3
+    };
+
+    static const quint32 BinaryMagic = 0x514D4642;
+    static const quint32 BinaryVersion = 1;
+
+    struct Statistics
+    {
+        quint64 bytesWritten;
+        quint64 recordsWritten;
+
+        int queueDepth;
+        int queueCapacity;
+
+        // Indexed by QtMsgType
+        quint64 dropped[5];
+
+        // Flushes of the log file that took from 2^i to 2^(i+1) microseconds,
+        //  the first bucket starts at 0 and the last one has no upper limit
+        quint64 flushLatency[FlushLatencyBuckets];
+    };
+
+    explicit QtMessageFilterLogWriter(const QString& fileName, QObject* parent = nullptr);
+    ~QtMessageFilterLogWriter();
+
+    bool write(const QByteArray& record, const QtMsgType type,
+               const OverloadPolicy policy = Block, const int timeout = -1,
+               const QSharedPointer<MessageDetails>& details = QSharedPointer<MessageDetails>(),
+               const QByteArray& fullMessage = QByteArray(), const int stackOffset = -1,
+               const qint64 sequence = -1);
+    void flush();
+    void stop();
+
+    void setCapacity(const int capacity);
+    quint64 dropped(const QtMsgType type) const;
+
+    Statistics statistics() const;
+    void setStatisticsRecord(const int interval, std::function<QByteArray(const Statistics&)> record);
+
+    void setTemplateMiner(QtMessageFilterTemplateMiner* miner);
+    void setMinedCallback(std::function<void(const QSharedPointer<MessageDetails>&)> callback);
+    void setBinaryLog(const QString& fileName);
+
+protected:
+
+    void run() override;
+
+private:
+
+    struct Record
+    {
+        QByteArray data;
+        QtMsgType type;
+
+        // The message to be mined, fullMessage is only set when it was truncated
+        QSharedPointer<MessageDetails> details;
+        QByteArray fullMessage;
+
+        // Position of the text of the stack on data, -1 without a stack
+        int stackOffset;
+    };
+
+    bool f_wait_for_space(const int size, const int timeout, const qint64 sequence);
+    int f_queued() const;
+    bool f_drop_oldest(const int capacity);
+    void f_release_in_order();
+    void f_count_dropped(const QtMsgType type);
+    QByteArray f_dropped_record();
+    void f_count_flush_latency(const qint64 microseconds);
+    QByteArray f_mine(const Record& record, QtMessageFilterTemplateMiner* miner, const bool binary);
+    quint32 f_binary_string(QDataStream& stream, const QByteArray& utf8);
+
+    const QString m_file_name;
+    const QDateTime m_begin_date_time;
+
+    QMutex m_mutex;
+    QWaitCondition m_wc_pending;
+    QWaitCondition m_wc_written;
+    QWaitCondition m_wc_space;
+
+    QQueue<Record> m_pending;
+
+    // Records queued before the ones of the previous sequences, and the sequences
+    //  dropped, they are moved to m_pending on the order of their sequence
+    QMap<quint64, Record> m_reordered;
+    QSet<quint64> m_skipped_sequences;
+    quint64 m_next_sequence;
+    QAtomicInt m_capacity;
+    QAtomicInt m_queue_depth;
+
+    quint64 m_count_queued;
+    quint64 m_count_written;
+
+    QAtomicInteger<quint64> m_bytes_written;
+    QAtomicInteger<quint64> m_records_written;
+    QAtomicInteger<quint64> m_flush_latency[FlushLatencyBuckets];
+
+    // Indexed by QtMsgType
+    QAtomicInteger<quint64> m_dropped[5];
+    quint64 m_dropped_unreported[5];
+
+    // Written each m_statistics_interval milliseconds, 0 disables it
+    int m_statistics_interval;
+    std::function<QByteArray(const Statistics&)> m_statistics_record;
+
+    // Owned by QtMessageFilterCore, only used on the writer thread
+    QtMessageFilterTemplateMiner* m_template_miner;
+    std::function<void(const QSharedPointer<MessageDetails>&)> m_mined_callback;
+
+    // Empty when there is no binary log, m_binary_strings is only used on the writer thread
+    QString m_binary_file_name;
+    QHash<QByteArray, quint32> m_binary_strings;
+
+    bool m_stop;
+};
+
+#endif // QTMESSAGEFILTERLOGWRITER_H
@@ -0,0 +1,367 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#include "qtmessagefilterpattern.h"
+#include "qtmessagefiltercore.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+// Indexed by QtMsgType
+static const char* const c_type_names[] = {"debug", "warning", "critical", "fatal", "info"};
+
+// Initialized when the library is loaded, the start of the process for %{time process}
+static const qint64 c_process_start_msecs = QDateTime::currentMSecsSinceEpoch();
+
+QtMessageFilterPattern::QtMessageFilterPattern(const QString& pattern)
+    : m_pattern(pattern.isEmpty() ? QtMessageFilterPattern::defaultPattern() : pattern),
+      m_operations(),
+      m_literal_size(0),
+      m_boot_msecs(QDateTime::currentMSecsSinceEpoch() - QElapsedTimer::msecsSinceReference())
+{
+    const QByteArray utf8 = m_pattern.toUtf8();
+
+    // Consecutive literals are a single operation
+    QByteArray literal;
+    auto appendLiteral = [this, &literal]
+    {
+        if(literal.isEmpty())
+            return;
+        m_operations.append(Operation{Literal, literal, QString(), IfDebug, 0});
+        m_literal_size += literal.size();
+        literal.clear();
+    };
+
+    // Indexes of the If operations without their EndIf yet
+    QVector<int> openIfs;
+
+    for(int i = 0; i < utf8.size(); )
+    {
+        const bool placeholderBegin = utf8.at(i) == '%' && i + 1 < utf8.size() && utf8.at(i + 1) == '{';
+        const int end = placeholderBegin ? utf8.indexOf('}', i + 2) : -1;
+        if(end < 0)
+        {
+            literal += utf8.at(i++);
+            continue;
+        }
+
+        const QByteArray name = utf8.mid(i + 2, end - i - 2);
+        const QByteArray placeholder = utf8.mid(i, end + 1 - i);
+        i = end + 1;
+
+        static const struct { const char* name; Kind kind; } fields[] =
+        {
+            {"time", Time}, {"type", Type}, {"id", Id}, {"file", File}, {"line", Line},
+            {"function", Function}, {"category", Category}, {"thread", Thread},
+            {"threadid", ThreadId}, {"message", Message}, {"sampled", Sampled}, {"stack", Stack}
+        };
+
+        static const struct { const char* name; Condition condition; } conditions[] =
+        {
+            {"if-debug", IfDebug}, {"if-info", IfInfo}, {"if-warning", IfWarning},
+            {"if-critical", IfCritical}, {"if-fatal", IfFatal}, {"if-category", IfCategory},
+            {"if-sampled", IfSampled}, {"if-stack", IfStack}
+        };
+
+        bool known = false;
+        for(const auto& k : fields)
+        {
+            if(name == k.name)
+            {
+                appendLiteral();
+                m_operations.append(Operation{k.kind, QByteArray(), QString(), IfDebug, 0});
+                known = true;
+                break;
+            }
+        }
+
+        for(const auto& k : conditions)
+        {
+            if(!known && name == k.name)
+            {
+                appendLiteral();
+                openIfs.append(m_operations.size());
+                m_operations.append(Operation{If, QByteArray(), QString(), k.condition, 0});
+                known = true;
+                break;
+            }
+        }
+
+        if(known)
+            continue;
+
+        if(name.startsWith("time "))
+        {
+            const QByteArray format = name.mid(5).trimmed();
+
+            appendLiteral();
+            if(format == "process")
+                m_operations.append(Operation{TimeProcess, QByteArray(), QString(), IfDebug, 0});
+            else if(format == "boot")
+                m_operations.append(Operation{TimeBoot, QByteArray(), QString(), IfDebug, 0});
+            else
+                m_operations.append(Operation{TimeFormat, QByteArray(), QString::fromUtf8(format), IfDebug, 0});
+        }
+        else if(name == "endif" && !openIfs.isEmpty())
+        {
+            appendLiteral();
+            m_operations[openIfs.takeLast()].next = m_operations.size() + 1;
+            m_operations.append(Operation{EndIf, QByteArray(), QString(), IfDebug, 0});
+        }
+        // The ones of the application are already known
+        else if(name == "pid")
+            literal += QByteArray::number(QCoreApplication::applicationPid());
+        else if(name == "appname")
+            literal += QCoreApplication::applicationName().toUtf8();
+        // Unknown placeholders are written as they are
+        else
+            literal += placeholder;
+    }
+
+    // An If without EndIf goes until the end, but not over the line break
+    if(utf8.endsWith('\n'))
+        literal.chop(1);
+    appendLiteral();
+
+    while(!openIfs.isEmpty())
+    {
+        m_operations[openIfs.takeLast()].next = m_operations.size() + 1;
+        m_operations.append(Operation{EndIf, QByteArray(), QString(), IfDebug, 0});
+    }
+
+    // Each record on its own line
+    literal += '\n';
+    appendLiteral();
+}
+
+QString QtMessageFilterPattern::pattern() const
+{
+    return m_pattern;
+}
+
+bool QtMessageFilterPattern::isDefault() const
+{
+    return m_pattern == QtMessageFilterPattern::defaultPattern();
+}
+
+QByteArray QtMessageFilterPattern::headerRecord() const
+{
+    // On a single line, whatever the pattern has
+    return "\\PATTERN " + m_pattern.toUtf8().toPercentEncoding() + "\n\n";
+}
+
+int QtMessageFilterPattern::literalSize() const
+{
+    return m_literal_size;
+}
+
+void QtMessageFilterPattern::format(QByteArray* out, const MessageDetails& details, const QByteArray& message,
+                                    const QByteArray& threadName, int* stackOffset) const
+{
+    if(stackOffset)
+        *stackOffset = -1;
+
+    for(int i = 0; i < m_operations.size(); )
+    {
+        const Operation& operation = m_operations.at(i);
+
+        switch(operation.kind)
+        {
+            case Literal:
+                out->append(operation.literal);
+                break;
+
+            case Time:
+            {
+                // ISO 8601 with milliseconds, without temporary strings
+                int year = 0, month = 0, day = 0;
+                details.dateTime.date().getDate(&year, &month, &day);
+                const QTime time = details.dateTime.time();
+
+                f_append_number(out, (quint64)qMax(0, year), 10, 4);
+                out->append('-');
+                f_append_number(out, (quint64)month, 10, 2);
+                out->append('-');
+                f_append_number(out, (quint64)day, 10, 2);
+                out->append('T');
+                f_append_number(out, (quint64)time.hour(), 10, 2);
+                out->append(':');
+                f_append_number(out, (quint64)time.minute(), 10, 2);
+                out->append(':');
+                f_append_number(out, (quint64)time.second(), 10, 2);
+                out->append('.');
+                f_append_number(out, (quint64)time.msec(), 10, 3);
+            }break;
+
+            case TimeFormat:
+                out->append(details.dateTime.toString(operation.timeFormat).toUtf8());
+                break;
+
+            case TimeProcess:
+                f_append_seconds(out, details.dateTime.toMSecsSinceEpoch() - c_process_start_msecs);
+                break;
+
+            case TimeBoot:
+                f_append_seconds(out, details.dateTime.toMSecsSinceEpoch() - m_boot_msecs);
+                break;
+
+            case Type:
+                out->append(c_type_names[details.type]);
+                break;
+
+            case Id:
+                f_append_number(out, details.id);
+                break;
+
+            case File:
+                out->append(details.fileNameUtf8);
+                break;
+
+            case Line:
+                if(details.line < 0)
+                    out->append('-');
+                f_append_number(out, (quint64)qAbs((qint64)details.line));
+                break;
+
+            case Function:
+                out->append(details.functionUtf8);
+                break;
+
+            case Category:
+                out->append(details.categoryUtf8);
+                break;
+
+            case Thread:
+                out->append(threadName);
+                out->append(" 0x", 3);
+                f_append_number(out, details.threadId, 16);
+                break;
+
+            case ThreadId:
+                out->append("0x", 2);
+                f_append_number(out, details.threadId, 16);
+                break;
+
+            case Message:
+                out->append(message);
+                break;
+
+            case Sampled:
+                f_append_number(out, details.sampledOut + 1);
+                break;
+
+            case Stack:
+                if(stackOffset && !details.stack.isEmpty())
+                    *stackOffset = out->size();
+                break;
+
+            case If:
+                if(!f_condition(operation.condition, details))
+                {
+                    i = operation.next;
+                    continue;
+                }
+                break;
+
+            case EndIf:
+                break;
+        }
+
+        i++;
+    }
+}
+
+QString QtMessageFilterPattern::defaultPattern()
+{
+    // The blocks read by QtMessageFilterLogReader
+    return "<<<<<<<<<<<<<<<%{id}<<<<<<<<<<<<<<<\n"
+           "\\origin:\n%{file} %{line}\n\n"
+           "\\function_call:\n%{function}\n\n"
+           "\\category:\n%{category}\n\n"
+           "\\thread:\n%{thread}\n\n"
+           "\\time_date:\n%{time}\n\n"
+           "%{if-sampled}\\sampled:\nkept 1 of %{sampled}\n\n%{endif}"
+           "%{if-stack}\\stack:\n%{stack}\n\n%{endif}"
+           "\\%{type}\\id%{id}: \n%{message}\n"
+           ">>>>>>>>>>>>>>>%{id}>>>>>>>>>>>>>>>\n";
+}
+
+bool QtMessageFilterPattern::f_condition(const Condition condition, const MessageDetails& details)
+{
+    switch(condition)
+    {
+        case IfDebug:
+            return details.type == QtDebugMsg;
+        case IfInfo:
+            return details.type == QtInfoMsg;
+        case IfWarning:
+            return details.type == QtWarningMsg;
+        case IfCritical:
+            return details.type == QtCriticalMsg;
+        case IfFatal:
+            return details.type == QtFatalMsg;
+        case IfCategory:
+            return !details.categoryUtf8.isEmpty() && details.categoryUtf8 != "default";
+        case IfSampled:
+            return details.sampledOut > 0;
+        case IfStack:
+            return !details.stack.isEmpty();
+    }
+    return false;
+}
+
+void QtMessageFilterPattern::f_append_number(QByteArray* out, quint64 value, const int base, const int width)
+{
+    // Written from the end of a buffer on the stack
+    char buffer[24];
+    int begin = (int)sizeof(buffer);
+    do
+    {
+        const int digit = (int)(value % base);
+        buffer[--begin] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    }
+    while(value > 0 && begin > 0);
+
+    while((int)sizeof(buffer) - begin < width && begin > 0)
+        buffer[--begin] = '0';
+
+    out->append(buffer + begin, (int)sizeof(buffer) - begin);
+}
+
+void QtMessageFilterPattern::f_append_seconds(QByteArray* out, const qint64 msecs)
+{
+    // As qFormatLogMessage() does, the seconds aligned on 6 columns
+    const quint64 value = (quint64)qMax<qint64>(0, msecs);
+
+    QByteArray seconds;
+    f_append_number(&seconds, value / 1000);
+    for(int i = seconds.size(); i < 6; i++)
+        out->append(' ');
+    out->append(seconds);
+    out->append('.');
+    f_append_number(out, value % 1000, 10, 3);
+}
@@ -0,0 +1,145 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef QTMESSAGEFILTERPATTERN_H
+#define QTMESSAGEFILTERPATTERN_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+
+struct MessageDetails;
+
+
+///
+/// \brief This class formats the records of the log file
+/// \details The pattern uses the placeholders of
+/// [qSetMessagePattern()](https://doc.qt.io/qt-5/qtglobal.html#qSetMessagePattern):
+/// * %{time} is the time of the message (ISO 8601 with milliseconds), %{time <format>}
+/// uses the format of QDateTime::toString(), %{time process} and %{time boot} are the
+/// seconds (with milliseconds) since the process started and since the system booted;
+/// * %{type} is "debug", "info", "warning", "critical" or "fatal";
+/// * %{id}, %{file}, %{line}, %{function}, %{category} and %{message};
+/// * %{thread} is the name and the id of the thread, %{threadid} only its id;
+/// * %{pid} and %{appname} are the ones of the application, when the pattern is compiled;
+/// * %{sampled} is how many messages the record represents (see MessageDetails::sampledOut)
+/// and %{stack} is where the symbolized stack is inserted by QtMessageFilterLogWriter;
+/// * %{if-debug}, %{if-info}, %{if-warning}, %{if-critical}, %{if-fatal}, %{if-category}
+/// (a category other than "default"), %{if-sampled} and %{if-stack} write what comes
+/// until %{endif} only when true, an %{if-*} without %{endif} goes until the end of
+/// the pattern.
+///
+/// The pattern is compiled once, by the constructor, to a flat list of operations, so
+/// QtMessageFilterPattern::format() only appends bytes already encoded to the record:
+/// no parsing and no temporary string (besides %{time <format>}). Each record ends
+/// with a line break, added when the pattern does not end with one, that is never
+/// skipped by a false condition.
+///
+/// QtMessageFilterPattern::defaultPattern() writes the records of blocks read by
+/// QtMessageFilterLogReader, the records of other patterns can not be read by it.
+/// QtMessageFilterPattern::headerRecord() is the line written on the log file before
+/// the records of a pattern, "\PATTERN <pattern percent-encoded>", so the reader knows
+/// which records it can read.
+///
+class QtMessageFilterPattern
+{
+public:
+
+    explicit QtMessageFilterPattern(const QString& pattern = QString());
+
+    QString pattern() const;
+    bool isDefault() const;
+    QByteArray headerRecord() const;
+    int literalSize() const;
+
+    void format(QByteArray* out, const MessageDetails& details, const QByteArray& message,
+                const QByteArray& threadName, int* stackOffset) const;
+
+    static QString defaultPattern();
+
+private:
+
+    enum Kind
+    {
+        Literal,
+        Time,
+        TimeFormat,
+        TimeProcess,
+        TimeBoot,
+        Type,
+        Id,
+        File,
+        Line,
+        Function,
+        Category,
+        Thread,
+        ThreadId,
+        Message,
+        Sampled,
+        Stack,
+        If,
+        EndIf
+    };
+
+    enum Condition
+    {
+        IfDebug,
+        IfInfo,
+        IfWarning,
+        IfCritical,
+        IfFatal,
+        IfCategory,
+        IfSampled,
+        IfStack
+    };
+
+    struct Operation
+    {
+        Kind kind;
+
+        // Bytes of a Literal
+        QByteArray literal;
+
+        // Format of a TimeFormat
+        QString timeFormat;
+
+        // Of an If, and the operation after its EndIf
+        Condition condition;
+        int next;
+    };
+
+    static bool f_condition(const Condition condition, const MessageDetails& details);
+    static void f_append_number(QByteArray* out, quint64 value, const int base = 10, const int width = 0);
+    static void f_append_seconds(QByteArray* out, const qint64 msecs);
+
+    QString m_pattern;
+    QVector<Operation> m_operations;
+    int m_literal_size;
+
+    // Milliseconds since the epoch when the system booted, for %{time boot}
+    qint64 m_boot_msecs;
+};
+
+#endif // QTMESSAGEFILTERPATTERN_H
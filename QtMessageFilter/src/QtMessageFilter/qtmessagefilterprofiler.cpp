@@ -0,0 +1,147 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "qtmessagefilterprofiler.h"
+
+QtMessageFilterProfiler::QtMessageFilterProfiler()
+    : m_shards(),
+      m_window_mutex(),
+      m_window()
+{
+    m_window.start();
+}
+
+bool QtMessageFilterProfiler::count(const char* file, const int line, const char* function, const qint64 bytes)
+{
+    // Look for the location without copying its strings
+    const Key key{QByteArray::fromRawData(file ? file : "", file ? (int)qstrlen(file) : 0),
+                  line,
+                  QByteArray::fromRawData(function ? function : "", function ? (int)qstrlen(function) : 0)};
+
+    Shard& shard = m_shards[qHash(key, 0) % Shards];
+    QMutexLocker locker(&shard.mutex);
+
+    auto i = shard.counters.find(key);
+    if(i == shard.counters.end())
+    {
+        const Key copy{QByteArray(key.fileName.constData(), key.fileName.size()),
+                       line,
+                       QByteArray(key.function.constData(), key.function.size())};
+        i = shard.counters.insert(copy, Counter{0, 0, 0, 0, false});
+    }
+
+    i->count++;
+    i->bytes += (quint64)qMax<qint64>(0, bytes);
+
+    return !i->silenced;
+}
+
+QList<QtMessageFilterProfiler::Location> QtMessageFilterProfiler::locations()
+{
+    // The rates are measured when the last window has at least one second
+    QMutexLocker windowLocker(&m_window_mutex);
+
+    const qint64 elapsed = m_window.elapsed();
+    const bool updateRate = elapsed >= 1000;
+    if(updateRate)
+        m_window.restart();
+
+    QList<Location> list;
+    for(Shard& shard : m_shards)
+    {
+        QMutexLocker locker(&shard.mutex);
+
+        for(auto i = shard.counters.begin(); i != shard.counters.end(); ++i)
+        {
+            if(updateRate)
+            {
+                i->rate = (i->count - i->windowCount)*1000.0/elapsed;
+                i->windowCount = i->count;
+            }
+
+            list.append(Location{QString::fromUtf8(i.key().fileName), i.key().line,
+                                 QString::fromUtf8(i.key().function),
+                                 i->count, i->bytes, i->rate, i->silenced});
+        }
+    }
+    return list;
+}
+
+void QtMessageFilterProfiler::setSilenced(const QString& fileName, const int line, const QString& function, const bool silenced)
+{
+    const Key key{fileName.toUtf8(), line, function.toUtf8()};
+
+    Shard& shard = m_shards[qHash(key, 0) % Shards];
+    QMutexLocker locker(&shard.mutex);
+
+    // A location can be silenced before its first message
+    auto i = shard.counters.find(key);
+    if(i == shard.counters.end())
+        i = shard.counters.insert(key, Counter{0, 0, 0, 0, false});
+
+    i->silenced = silenced;
+}
+
+void QtMessageFilterProfiler::clear()
+{
+    for(Shard& shard : m_shards)
+    {
+        QMutexLocker locker(&shard.mutex);
+
+        // The silenced locations continue silenced
+        for(auto i = shard.counters.begin(); i != shard.counters.end(); )
+        {
+            if(i->silenced)
+            {
+                *i = Counter{0, 0, 0, 0, true};
+                ++i;
+            }
+            else
+                i = shard.counters.erase(i);
+        }
+    }
+}
+
+QByteArray QtMessageFilterProfiler::toCsv(const QList<Location>& locations)
+{
+    auto quoted = [](const QString& str)
+    {
+        return '"' + str.toUtf8().replace('"', "\"\"") + '"';
+    };
+
+    QByteArray csv("file,line,function,count,bytes,rate,silenced\n");
+    for(const Location& k : locations)
+    {
+        csv += quoted(k.fileName) + ',' + QByteArray::number(k.line) + ',' + quoted(k.function) + ',' +
+                QByteArray::number(k.count) + ',' + QByteArray::number(k.bytes) + ',' +
+                QByteArray::number(k.rate, 'f', 2) + ',' + (k.silenced ? "1" : "0") + '\n';
+    }
+    return csv;
+}
+
+bool QtMessageFilterProfiler::Key::operator==(const Key& that) const
+{
+    return line == that.line && fileName == that.fileName && function == that.function;
+}
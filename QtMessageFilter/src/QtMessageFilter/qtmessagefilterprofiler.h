@@ -0,0 +1,128 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef QTMESSAGEFILTERPROFILER_H
+#define QTMESSAGEFILTERPROFILER_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+
+///
+/// \brief This class counts the messages generated on each location of the code
+/// \details A location is the file, line and function of the
+/// [QMessageLogContext](https://doc.qt.io/qt-5/qmessagelogcontext.html) of the
+/// message. QtMessageFilterCore calls QtMessageFilterProfiler::count() for every
+/// message, right after encoding it (the bytes are the ones of its UTF-8) and before
+/// anything else, so the count and the bytes of each location include the messages
+/// that are later sampled or dropped.
+///
+/// The locations are spread on shards, each one with its own mutex, so threads
+/// generating messages on different locations rarely wait for each other.
+/// Looking for a location does not copy its strings, they are only copied the
+/// first time the location is seen.
+///
+/// A location can be silenced with QtMessageFilterProfiler::setSilenced(), its
+/// messages are still counted but QtMessageFilterProfiler::count() returns false
+/// and they are discarded.
+///
+/// QtMessageFilterProfiler::locations() returns a copy of the counters, the rate
+/// (messages per second) of each location is measured between the calls, on
+/// windows of at least one second. QtMessageFilterProfiler::toCsv() exports the
+/// same copy.
+///
+class QtMessageFilterProfiler
+{
+public:
+
+    struct Location
+    {
+        QString fileName;
+        int line;
+        QString function;
+
+        quint64 count;
+        quint64 bytes;
+        double rate;
+
+        bool silenced;
+    };
+
+    QtMessageFilterProfiler();
+
+    bool count(const char* file, const int line, const char* function, const qint64 bytes);
+
+    QList<Location> locations();
+    void setSilenced(const QString& fileName, const int line, const QString& function, const bool silenced);
+    void clear();
+
+    static QByteArray toCsv(const QList<Location>& locations);
+
+private:
+
+    struct Key
+    {
+        QByteArray fileName;
+        int line;
+        QByteArray function;
+
+        bool operator==(const Key& that) const;
+    };
+
+    friend uint qHash(const Key& key, uint seed)
+    {
+        return qHash(key.fileName, seed) ^ (31*qHash(key.function, seed)) ^ (uint)key.line;
+    }
+
+    struct Counter
+    {
+        quint64 count;
+        quint64 bytes;
+
+        // Count on the beginning of the window of the rate
+        quint64 windowCount;
+        double rate;
+
+        bool silenced;
+    };
+
+    struct Shard
+    {
+        QMutex mutex;
+        QHash<Key, Counter> counters;
+    };
+
+    static const int Shards = 16;
+
+    Shard m_shards[Shards];
+
+    QMutex m_window_mutex;
+    QElapsedTimer m_window;
+};
+
+#endif // QTMESSAGEFILTERPROFILER_H
@@ -0,0 +1,107 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "qtmessagefiltersampler.h"
+
+#include <QRandomGenerator>
+
+#include <cmath>
+
+QtMessageFilterSampler::QtMessageFilterSampler(const Mode mode, const double value)
+    : m_mode(mode),
+      m_value(value),
+      m_every_nth(1),
+      m_window(),
+      m_window_count(0),
+      m_locations()
+{
+    if(m_mode == EveryNth)
+        m_every_nth = (quint64)qMax(1.0, m_value);
+
+    m_window.start();
+}
+
+bool QtMessageFilterSampler::sample(const char* file, const int line, quint64* sampledOut)
+{
+    if(m_mode == RateBudget)
+        f_adapt_rate();
+
+    // Look for the location without copying the name of the file
+    const QByteArray fileName = QByteArray::fromRawData(file ? file : "", file ? (int)qstrlen(file) : 0);
+    auto i = m_locations.find(Location(fileName, line));
+    if(i == m_locations.end())
+        i = m_locations.insert(Location(QByteArray(fileName.constData(), fileName.size()), line), LocationCounter{0, 0});
+
+    bool keep;
+    if(m_mode == Probabilistic)
+        keep = QRandomGenerator::global()->generateDouble() < m_value;
+    else
+        keep = (i->seen % m_every_nth) == 0;
+
+    i->seen++;
+
+    if(!keep)
+    {
+        i->sampledOut++;
+        return false;
+    }
+
+    if(sampledOut)
+        *sampledOut = i->sampledOut;
+    i->sampledOut = 0;
+    return true;
+}
+
+QList<QtMessageFilterSampler::SampledOut> QtMessageFilterSampler::takeSampledOut()
+{
+    // The next message kept only tells the ones dropped after this
+    QList<SampledOut> list;
+    for(auto i = m_locations.begin(); i != m_locations.end(); ++i)
+    {
+        if(i->sampledOut == 0)
+            continue;
+
+        list.append(SampledOut{i.key().first, i.key().second, i->sampledOut});
+        i->sampledOut = 0;
+    }
+    return list;
+}
+
+void QtMessageFilterSampler::f_adapt_rate()
+{
+    m_window_count++;
+
+    const qint64 elapsed = m_window.elapsed();
+    if(elapsed < 1000)
+        return;
+
+    // Keep one of each N messages, where N is the ratio between the
+    //  rate observed on the last window and the budget
+    const double rate = m_window_count*1000.0/elapsed;
+    m_every_nth = (quint64)qMax(1.0, std::ceil(rate/qMax(m_value, 1e-3)));
+
+    m_window_count = 0;
+    m_window.restart();
+}
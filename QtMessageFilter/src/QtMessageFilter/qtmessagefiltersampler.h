@@ -0,0 +1,103 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef QTMESSAGEFILTERSAMPLER_H
+#define QTMESSAGEFILTERSAMPLER_H
+
+#include <QHash>
+#include <QPair>
+#include <QList>
+#include <QByteArray>
+#include <QElapsedTimer>
+
+
+///
+/// \brief This class decides which messages of a type or category are kept
+/// \details It is used by QtMessageFilterCore to keep only a sample of the
+/// messages of high volume types or categories. The sample is taken for each
+/// location (file and line) that generates the messages:
+/// * EveryNth: keeps the first message of each N of the location;
+/// * Probabilistic: keeps each message with the given probability;
+/// * RateBudget: keeps every Nth message, N is adapted each second so that
+/// the messages kept by the sampler stay around the given rate (messages
+/// per second).
+///
+/// The messages dropped by the sampler are counted on their location, when a
+/// message is kept QtMessageFilterSampler::sample() tells how many messages of
+/// its location were dropped since the last one kept. A location that stops
+/// generating messages would keep its count forever, so
+/// QtMessageFilterSampler::takeSampledOut() returns the counts not reported yet
+/// (and resets them), QtMessageFilterCore writes them on the log file.
+///
+/// This class is not thread-safe, QtMessageFilterCore protects it with a mutex.
+///
+class QtMessageFilterSampler
+{
+public:
+
+    enum Mode
+    {
+        EveryNth,
+        Probabilistic,
+        RateBudget
+    };
+
+    struct SampledOut
+    {
+        QByteArray fileName;
+        int line;
+        quint64 count;
+    };
+
+    QtMessageFilterSampler(const Mode mode, const double value);
+
+    bool sample(const char* file, const int line, quint64* sampledOut);
+    QList<SampledOut> takeSampledOut();
+
+private:
+
+    typedef QPair<QByteArray, int> Location;
+
+    struct LocationCounter
+    {
+        quint64 seen;
+        quint64 sampledOut;
+    };
+
+    void f_adapt_rate();
+
+    const Mode m_mode;
+    const double m_value;
+
+    // Keep one of each m_every_nth messages of a location
+    quint64 m_every_nth;
+
+    // Messages seen on the current window of RateBudget
+    QElapsedTimer m_window;
+    quint64 m_window_count;
+
+    QHash<Location, LocationCounter> m_locations;
+};
+
+#endif // QTMESSAGEFILTERSAMPLER_H
@@ -0,0 +1,422 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#include "qtmessagefiltersearch.h"
+#include "qtmessagefilterlogreader.h"
+
+#include <QtConcurrentMap>
+#include <QRegularExpression>
+#include <QFile>
+
+// Messages (or ids) of each chunk of the retained ones
+static const int c_store_chunk_size = 16*1024;
+
+// Bytes of each chunk of a log file
+static const qint64 c_file_chunk_size = 4*1024*1024;
+
+// Items checked between the checks of the cancellation
+static const int c_check_interval = 1024;
+
+struct QtMessageFilterSearch::Matcher
+{
+    Query query;
+    QRegularExpression expression;
+
+    // The query on UTF-8, compared to the retained messages without decoding them
+    QByteArray categoryUtf8;
+    QByteArray fileNameUtf8;
+    QByteArray functionUtf8;
+    QByteArray textUtf8;
+
+    explicit Matcher(const Query& thatQuery)
+        : query(thatQuery),
+          expression(),
+          categoryUtf8(thatQuery.category.toUtf8()),
+          fileNameUtf8(thatQuery.fileName.toUtf8()),
+          functionUtf8(thatQuery.function.toUtf8()),
+          textUtf8(thatQuery.text.toUtf8())
+    {
+        if(query.regularExpression)
+        {
+            expression.setPattern(query.text);
+            if(query.caseSensitivity == Qt::CaseInsensitive)
+                expression.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+
+            // Compiled once, not by the first match of each thread
+            expression.optimize();
+        }
+    }
+
+    bool matchesContext(const QtMsgType type, const quintptr threadId, const int line, const QDateTime& dateTime) const
+    {
+        // The cheapest comparisons first
+        if(!(query.types & (1 << type)))
+            return false;
+        if(query.threadId && threadId != query.threadId)
+            return false;
+        if(query.line > 0 && line != query.line)
+            return false;
+        if(query.from.isValid() && dateTime < query.from)
+            return false;
+        if(query.to.isValid() && dateTime > query.to)
+            return false;
+        return true;
+    }
+
+    bool matchesText(const QString& message) const
+    {
+        if(query.text.isEmpty())
+            return true;
+        if(query.regularExpression)
+            return expression.match(message).hasMatch();
+        return message.contains(query.text, query.caseSensitivity);
+    }
+
+    bool matches(const MessageDetails& details) const
+    {
+        if(!matchesContext(details.type, details.threadId, details.line, details.dateTime))
+            return false;
+        if(!query.category.isEmpty() && details.categoryUtf8 != categoryUtf8)
+            return false;
+        if(!query.fileName.isEmpty() && !details.fileNameUtf8.contains(fileNameUtf8))
+            return false;
+        if(!query.function.isEmpty() && !details.functionUtf8.contains(functionUtf8))
+            return false;
+
+        // Only the regular expressions and the texts ignoring the case decode the message
+        if(!query.text.isEmpty() && !query.regularExpression && query.caseSensitivity == Qt::CaseSensitive)
+            return details.messageUtf8.contains(textUtf8);
+        return matchesText(details.message());
+    }
+
+    bool matches(const QtMessageFilterLogReader::Record& record) const
+    {
+        if(!matchesContext(record.type, record.threadId, record.line, record.dateTime))
+            return false;
+        if(!query.category.isEmpty() && record.category != query.category)
+            return false;
+        if(!query.fileName.isEmpty() && !record.fileName.contains(query.fileName))
+            return false;
+        if(!query.function.isEmpty() && !record.function.contains(query.function))
+            return false;
+        return matchesText(record.message);
+    }
+};
+
+struct QtMessageFilterSearch::StoreSearch
+{
+    typedef Results result_type;
+
+    QSharedPointer<const Results> messages;
+    QSharedPointer<const Matcher> matcher;
+    QSharedPointer<QAtomicInt> generation;
+    int expectedGeneration;
+
+    Results operator()(const Chunk& chunk) const
+    {
+        Results results;
+        for(qint64 i = chunk.begin; i < chunk.end; i++)
+        {
+            if((i - chunk.begin) % c_check_interval == 0 && generation->loadAcquire() != expectedGeneration)
+                return Results();
+
+            const QSharedPointer<MessageDetails>& details = messages->at((int)i);
+            if(matcher->matches(*details))
+                results.append(details);
+        }
+        return results;
+    }
+};
+
+struct QtMessageFilterSearch::RetainedSearch
+{
+    typedef Results result_type;
+
+    QSharedPointer<const Matcher> matcher;
+    QSharedPointer<QAtomicInt> generation;
+    int expectedGeneration;
+
+    Results operator()(const Chunk& chunk) const
+    {
+        if(generation->loadAcquire() != expectedGeneration)
+            return Results();
+
+        // Only the ids of the chunk are copied, under the mutex of QtMessageFilterCore
+        const Results messages = QtMessageFilterCore::messagesInRange((ulong)chunk.begin, (ulong)chunk.end,
+                                                                      matcher->query.threadId);
+
+        Results results;
+        for(int i = 0; i < messages.size(); i++)
+        {
+            if(i % c_check_interval == 0 && generation->loadAcquire() != expectedGeneration)
+                return Results();
+
+            if(matcher->matches(*messages.at(i)))
+                results.append(messages.at(i));
+        }
+        return results;
+    }
+};
+
+struct QtMessageFilterSearch::FileSearch
+{
+    typedef Results result_type;
+
+    QString fileName;
+    QSharedPointer<const Matcher> matcher;
+    QSharedPointer<QAtomicInt> generation;
+    int expectedGeneration;
+
+    static qint64 recordBoundary(QFile* file, const qint64 position)
+    {
+        // The first record after the position, it begins right after the end
+        //  marker of the last one. Both chunks around the position find the same one
+        static const QByteArray boundary(">>>>>>>>>>>>>>>\n<<<<<<<<<<<<<<<");
+
+        if(position <= 0)
+            return 0;
+        if(position >= file->size() || !file->seek(position))
+            return file->size();
+
+        QByteArray window;
+        qint64 windowBegin = position;
+        for(;;)
+        {
+            const QByteArray data = file->read(64*1024);
+            if(data.isEmpty())
+                return file->size();
+            window += data;
+
+            const int index = window.indexOf(boundary);
+            if(index >= 0)
+                return windowBegin + index + boundary.indexOf('<');
+
+            // Keep the end, the boundary may be split between two reads
+            const int keep = boundary.size() - 1;
+            windowBegin += window.size() - keep;
+            window = window.right(keep);
+        }
+    }
+
+    Results operator()(const Chunk& chunk) const
+    {
+        QFile file(fileName);
+        if(!file.open(QIODevice::ReadOnly))
+            return Results();
+
+        const qint64 begin = recordBoundary(&file, chunk.begin);
+        const qint64 end = recordBoundary(&file, chunk.end);
+        if(begin >= end || !file.seek(begin))
+            return Results();
+
+        QtMessageFilterLogReader reader;
+        Results results;
+        for(qint64 position = begin; position < end; )
+        {
+            if(generation->loadAcquire() != expectedGeneration)
+                return Results();
+
+            const QByteArray data = file.read(qMin<qint64>(1024*1024, end - position));
+            if(data.isEmpty())
+                break;
+            position += data.size();
+
+            for(const QtMessageFilterLogReader::Record& k : reader.read(data))
+            {
+                if(k.kind == QtMessageFilterLogReader::Record::Message && matcher->matches(k))
+                {
+                    results.append(QtMessageFilterLogReader::toMessageDetails(k));
+                }
+            }
+        }
+        return results;
+    }
+};
+
+QtMessageFilterSearch::Query::Query()
+    : types((1 << QtDebugMsg) | (1 << QtInfoMsg) | (1 << QtWarningMsg) | (1 << QtCriticalMsg) | (1 << QtFatalMsg)),
+      threadId(0),
+      category(),
+      fileName(),
+      line(0),
+      function(),
+      text(),
+      regularExpression(false),
+      caseSensitivity(Qt::CaseInsensitive),
+      from(),
+      to()
+{
+
+}
+
+QtMessageFilterSearch::QtMessageFilterSearch(QObject* parent)
+    : QObject(parent),
+      m_generation(new QAtomicInt(0)),
+      m_matcher(new Matcher(Query())),
+      m_watcher(nullptr),
+      m_running(false),
+      m_pending_results(),
+      m_next_chunk(0),
+      m_count(0),
+      m_last_searched_id(-1)
+{
+
+}
+
+QtMessageFilterSearch::~QtMessageFilterSearch()
+{
+    // The chunks running hold their own data, they only need to stop
+    cancel();
+}
+
+void QtMessageFilterSearch::search(const Query& query)
+{
+    cancel();
+
+    m_matcher.reset(new Matcher(query));
+    m_last_searched_id = -1;
+
+    // Chunks of ids, each one read by its own chunk of the search
+    QList<Chunk> chunks;
+    ulong firstId = 0;
+    ulong lastId = 0;
+    if(QtMessageFilterCore::retainedIds(&firstId, &lastId))
+    {
+        m_last_searched_id = (qint64)lastId;
+        for(qint64 i = (qint64)firstId; i <= (qint64)lastId; i += c_store_chunk_size)
+            chunks.append(Chunk{i, qMin<qint64>(i + c_store_chunk_size, (qint64)lastId + 1)});
+    }
+
+    const RetainedSearch functor{m_matcher, m_generation, m_generation->loadAcquire()};
+    f_start(QtConcurrent::mapped(chunks, functor));
+}
+
+void QtMessageFilterSearch::search(const QList<QSharedPointer<MessageDetails>>& messages, const Query& query)
+{
+    cancel();
+
+    m_matcher.reset(new Matcher(query));
+    m_last_searched_id = messages.isEmpty() ? -1 : (qint64)messages.last()->id;
+
+    QList<Chunk> chunks;
+    for(qint64 i = 0; i < messages.size(); i += c_store_chunk_size)
+        chunks.append(Chunk{i, qMin<qint64>(i + c_store_chunk_size, messages.size())});
+
+    const StoreSearch functor{QSharedPointer<const Results>(new Results(messages)), m_matcher,
+                              m_generation, m_generation->loadAcquire()};
+    f_start(QtConcurrent::mapped(chunks, functor));
+}
+
+bool QtMessageFilterSearch::searchFile(const QString& fileName, const Query& query)
+{
+    cancel();
+
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    m_matcher.reset(new Matcher(query));
+    m_last_searched_id = -1;
+
+    QList<Chunk> chunks;
+    for(qint64 i = 0; i < file.size(); i += c_file_chunk_size)
+        chunks.append(Chunk{i, qMin(i + c_file_chunk_size, file.size())});
+
+    const FileSearch functor{fileName, m_matcher, m_generation, m_generation->loadAcquire()};
+    f_start(QtConcurrent::mapped(chunks, functor));
+    return true;
+}
+
+void QtMessageFilterSearch::cancel()
+{
+    m_generation->ref();
+    m_running = false;
+    m_pending_results.clear();
+
+    if(m_watcher)
+    {
+        m_watcher->disconnect(this);
+        m_watcher->cancel();
+        m_watcher->deleteLater();
+        m_watcher = nullptr;
+    }
+}
+
+bool QtMessageFilterSearch::isRunning() const
+{
+    return m_running;
+}
+
+bool QtMessageFilterSearch::matches(const MessageDetails& details) const
+{
+    return m_matcher->matches(details);
+}
+
+qint64 QtMessageFilterSearch::lastSearchedId() const
+{
+    return m_last_searched_id;
+}
+
+void QtMessageFilterSearch::f_start(const QFuture<Results>& future)
+{
+    m_running = true;
+    m_next_chunk = 0;
+    m_count = 0;
+
+    m_watcher = new QFutureWatcher<Results>(this);
+    connect(m_watcher, &QFutureWatcherBase::resultReadyAt,
+            this, &QtMessageFilterSearch::f_result_ready);
+    connect(m_watcher, &QFutureWatcherBase::finished,
+            this, &QtMessageFilterSearch::f_finished);
+    m_watcher->setFuture(future);
+}
+
+void QtMessageFilterSearch::f_result_ready(const int index)
+{
+    m_pending_results.insert(index, m_watcher->resultAt(index));
+
+    // Emitted on the order of the chunks
+    while(m_pending_results.contains(m_next_chunk))
+    {
+        const Results results = m_pending_results.take(m_next_chunk++);
+        if(results.isEmpty())
+            continue;
+
+        m_count += results.size();
+        Q_EMIT signal_results(results);
+    }
+}
+
+void QtMessageFilterSearch::f_finished()
+{
+    m_running = false;
+    m_pending_results.clear();
+
+    m_watcher->deleteLater();
+    m_watcher = nullptr;
+
+    Q_EMIT signal_finished(m_count);
+}
@@ -0,0 +1,152 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef QTMESSAGEFILTERSEARCH_H
+#define QTMESSAGEFILTERSEARCH_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QMap>
+#include <QDateTime>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QFutureWatcher>
+
+#include "qtmessagefiltercore.h"
+
+
+///
+/// \brief This class filters and searches messages on several threads
+/// \details A Query selects the messages by type, thread, category, location
+/// (file, line and function), text (or regular expression) and time. It can run
+/// over the messages retained by QtMessageFilterCore, with
+/// QtMessageFilterSearch::search(), or over a log file, with
+/// QtMessageFilterSearch::searchFile(), which can be much bigger than the memory.
+///
+/// The messages (or the file) are split in chunks that are evaluated in parallel by
+/// QtConcurrent on the global thread pool. The results of each chunk are emitted with
+/// signal_results() as soon as the chunks before it are done, so they always arrive on
+/// the order of the ids and the view can show them progressively. signal_finished()
+/// is emitted after the last chunk.
+///
+/// The retained messages are not copied by QtMessageFilterSearch::search(), each chunk
+/// reads its range of ids with QtMessageFilterCore::messagesInRange() when it runs, so
+/// the mutex of QtMessageFilterCore is only held for one chunk at a time and never by
+/// the thread that starts the search. The messages released before their chunk runs
+/// are not searched.
+///
+/// A new search cancels the last one: its chunks not started yet are dropped, the ones
+/// running stop on their next check and none of its results is emitted anymore. The
+/// chunks of a log file begin on the boundaries between its records, each one is
+/// parsed by its own QtMessageFilterLogReader.
+///
+/// The text is only looked for on the part of the message retained on memory (see
+/// MessageDetails::isTruncated()).
+///
+class QtMessageFilterSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    struct Query
+    {
+        // Bits of (1 << QtMsgType), every type by default
+        int types;
+
+        // 0 is any thread
+        quintptr threadId;
+
+        // Empty is any category
+        QString category;
+
+        // Parts of the location, empty (or line 0) is any location
+        QString fileName;
+        int line;
+        QString function;
+
+        QString text;
+        bool regularExpression;
+        Qt::CaseSensitivity caseSensitivity;
+
+        // An invalid date does not limit the time
+        QDateTime from;
+        QDateTime to;
+
+        Query();
+    };
+
+    explicit QtMessageFilterSearch(QObject* parent = nullptr);
+    ~QtMessageFilterSearch();
+
+    void search(const Query& query);
+    void search(const QList<QSharedPointer<MessageDetails>>& messages, const Query& query);
+    bool searchFile(const QString& fileName, const Query& query);
+    void cancel();
+
+    bool isRunning() const;
+    bool matches(const MessageDetails& details) const;
+    qint64 lastSearchedId() const;
+
+Q_SIGNALS:
+    void signal_results(QList<QSharedPointer<MessageDetails>> results);
+    void signal_finished(const int count);
+
+private:
+
+    struct Chunk
+    {
+        qint64 begin;
+        qint64 end;
+    };
+
+    struct Matcher;
+    struct StoreSearch;
+    struct RetainedSearch;
+    struct FileSearch;
+
+    typedef QList<QSharedPointer<MessageDetails>> Results;
+
+    void f_start(const QFuture<Results>& future);
+    void f_result_ready(const int index);
+    void f_finished();
+
+    // Incremented by each search, the chunks of an older search stop
+    QSharedPointer<QAtomicInt> m_generation;
+
+    QSharedPointer<const Matcher> m_matcher;
+    QFutureWatcher<Results>* m_watcher;
+    bool m_running;
+
+    // Results of the chunks that finished before the ones before them
+    QMap<int, Results> m_pending_results;
+    int m_next_chunk;
+    int m_count;
+
+    qint64 m_last_searched_id;
+};
+
+#endif // QTMESSAGEFILTERSEARCH_H
@@ -0,0 +1,120 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+
+#include "qtmessagefilterstacktrace.h"
+
+#include <QFileInfo>
+
+#if defined(Q_OS_LINUX) && defined(__GLIBC__)
+#define QTMESSAGEFILTER_HAS_BACKTRACE
+#include <execinfo.h>
+#include <dlfcn.h>
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+QMutex QtMessageFilterStackTrace::m_cache_mutex;
+QHash<quintptr, QString> QtMessageFilterStackTrace::m_cache;
+
+QVector<quintptr> QtMessageFilterStackTrace::capture(const int skip, const int maximumFrames)
+{
+#ifdef QTMESSAGEFILTER_HAS_BACKTRACE
+    // This function is also a frame
+    QVector<void*> frames(maximumFrames + skip + 1);
+    const int count = backtrace(frames.data(), frames.size());
+
+    QVector<quintptr> stack;
+    for(int i = skip + 1; i < count; i++)
+        stack.append((quintptr)frames.at(i));
+    return stack;
+#else
+    Q_UNUSED(skip)
+    Q_UNUSED(maximumFrames)
+    return QVector<quintptr>();
+#endif
+}
+
+QString QtMessageFilterStackTrace::symbolize(const quintptr address)
+{
+    {
+        QMutexLocker locker(&m_cache_mutex);
+
+        auto i = m_cache.constFind(address);
+        if(i != m_cache.constEnd())
+            return i.value();
+    }
+
+    // Resolved without the lock, two threads may resolve the same address
+    //  but the result is the same
+    const QString symbol = f_resolve(address);
+
+    QMutexLocker locker(&m_cache_mutex);
+    m_cache.insert(address, symbol);
+    return symbol;
+}
+
+QString QtMessageFilterStackTrace::toText(const QVector<quintptr>& stack)
+{
+    QString text;
+    for(int i = 0; i < stack.size(); i++)
+    {
+        if(i > 0)
+            text += '\n';
+        text += '#' + QString::number(i) + ' ' + symbolize(stack.at(i));
+    }
+    return text;
+}
+
+QString QtMessageFilterStackTrace::f_resolve(const quintptr address)
+{
+    QString symbol = "0x" + QString::number(address, 16);
+
+#ifdef QTMESSAGEFILTER_HAS_BACKTRACE
+    // The addresses are the return ones, the call is on the byte before
+    Dl_info info;
+    if(!dladdr((void*)(address - 1), &info))
+        return symbol;
+
+    if(info.dli_sname)
+    {
+        int status = -1;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        symbol += ' ' + QString::fromUtf8(status == 0 && demangled ? demangled : info.dli_sname) +
+                "+0x" + QString::number(address - (quintptr)info.dli_saddr, 16);
+        free(demangled);
+    }
+    else
+        symbol += " ??";
+
+    if(info.dli_fname)
+    {
+        symbol += " (" + QFileInfo(QString::fromLocal8Bit(info.dli_fname)).fileName() +
+                "+0x" + QString::number(address - (quintptr)info.dli_fbase, 16) + ')';
+    }
+#endif
+
+    return symbol;
+}
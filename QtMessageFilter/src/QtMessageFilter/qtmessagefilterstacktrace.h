@@ -0,0 +1,67 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#ifndef QTMESSAGEFILTERSTACKTRACE_H
+#define QTMESSAGEFILTERSTACKTRACE_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+
+
+///
+/// \brief This class captures and symbolizes the call stack of a message
+/// \details QtMessageFilterStackTrace::capture() only copies the return addresses of
+/// the stack, with `backtrace()` of glibc, it is cheap enough to be called on the
+/// message handler. Converting the addresses to names (the symbolization) is much more
+/// expensive, so it is only done when the stack is shown or written on the log file,
+/// by QtMessageFilterStackTrace::toText(). Each address is symbolized once, with
+/// `dladdr()` and the demangler of the C++ ABI, and cached, so repeated stacks cost
+/// only the lookup on the cache.
+///
+/// `dladdr()` only knows the dynamic symbols, link the application with `-rdynamic`
+/// to see the names of its own functions. The frames without a name show their module
+/// and offset, which can be resolved offline with `addr2line`.
+///
+/// On other platforms than Linux with glibc the stack is always empty.
+///
+class QtMessageFilterStackTrace
+{
+public:
+
+    static QVector<quintptr> capture(const int skip = 0, const int maximumFrames = 64);
+    static QString symbolize(const quintptr address);
+    static QString toText(const QVector<quintptr>& stack);
+
+private:
+
+    static QString f_resolve(const quintptr address);
+
+    static QMutex m_cache_mutex;
+    static QHash<quintptr, QString> m_cache;
+};
+
+#endif // QTMESSAGEFILTERSTACKTRACE_H
@@ -0,0 +1,255 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+
+#include "qtmessagefiltertemplateminer.h"
+
+// Token of a parameter on the templates
+static const QByteArray c_wildcard("<*>");
+
+QtMessageFilterTemplateMiner::QtMessageFilterTemplateMiner(const int depth, const double similarity,
+                                                           const int maximumChildren, const int maximumTokens,
+                                                           const int maximumTemplates)
+    : m_depth(qMax(3, depth)),
+      m_similarity(similarity),
+      m_maximum_children(qMax(1, maximumChildren)),
+      m_maximum_tokens(maximumTokens),
+      m_maximum_templates(qMax(1, maximumTemplates)),
+      m_mutex(),
+      m_roots(),
+      m_clusters(),
+      m_next_id(0),
+      m_lru(),
+      m_hits(0),
+      m_template_count(0),
+      m_evicted(0)
+{
+
+}
+
+QtMessageFilterTemplateMiner::Result QtMessageFilterTemplateMiner::mine(const QByteArray& message)
+{
+    // Split on each space, so joining the tokens gives the same message
+    const QList<QByteArray> tokens = message.split(' ');
+    if(tokens.size() > m_maximum_tokens)
+        return Result{-1, false, QList<QByteArray>()};
+
+    QList<QByteArray> masked = tokens;
+    for(QByteArray& k : masked)
+    {
+        if(f_is_parameter(k))
+            k = c_wildcard;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    const QSharedPointer<Node> leaf = f_leaf(masked);
+
+    // The most similar template of the leaf, on a tie the one with more parameters
+    int best = -1;
+    double bestSimilarity = -1;
+    int bestParameters = -1;
+    for(const int k : qAsConst(leaf->clusters))
+    {
+        const QList<QByteArray>& clusterTokens = m_clusters[k].tokens;
+
+        int equal = 0;
+        int parameters = 0;
+        for(int i = 0; i < clusterTokens.size(); i++)
+        {
+            if(clusterTokens.at(i) == c_wildcard)
+                parameters++;
+            else if(clusterTokens.at(i) == masked.at(i))
+                equal++;
+        }
+
+        const double similarity = (double)equal/masked.size();
+        if(similarity > bestSimilarity || (similarity == bestSimilarity && parameters > bestParameters))
+        {
+            best = k;
+            bestSimilarity = similarity;
+            bestParameters = parameters;
+        }
+    }
+
+    bool changed = false;
+    if(best >= 0 && bestSimilarity >= m_similarity)
+    {
+        // The tokens that differ become parameters
+        QList<QByteArray>& clusterTokens = m_clusters[best].tokens;
+        for(int i = 0; i < clusterTokens.size(); i++)
+        {
+            if(clusterTokens.at(i) != c_wildcard && clusterTokens.at(i) != masked.at(i))
+            {
+                clusterTokens[i] = c_wildcard;
+                changed = true;
+            }
+        }
+    }
+    else
+    {
+        if(m_clusters.size() >= m_maximum_templates)
+            f_evict_least_recent();
+
+        best = m_next_id++;
+        m_clusters.insert(best, Cluster{masked, 0, leaf, 0});
+        leaf->clusters.append(best);
+        m_template_count.storeRelease(m_clusters.size());
+        changed = true;
+    }
+
+    Cluster& cluster = m_clusters[best];
+    cluster.count++;
+
+    // The most recent hit goes to the end
+    if(cluster.lastHit > 0)
+        m_lru.remove(cluster.lastHit);
+    cluster.lastHit = ++m_hits;
+    m_lru.insert(cluster.lastHit, best);
+
+    Result result{best, changed, QList<QByteArray>()};
+    for(int i = 0; i < cluster.tokens.size(); i++)
+    {
+        if(cluster.tokens.at(i) == c_wildcard)
+            result.parameters.append(tokens.at(i));
+    }
+    return result;
+}
+
+QByteArray QtMessageFilterTemplateMiner::templateOf(const int templateId) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto cluster = m_clusters.constFind(templateId);
+    if(cluster == m_clusters.constEnd())
+        return QByteArray();
+
+    return cluster->tokens.join(' ');
+}
+
+quint64 QtMessageFilterTemplateMiner::countOf(const int templateId) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto cluster = m_clusters.constFind(templateId);
+    if(cluster == m_clusters.constEnd())
+        return 0;
+
+    return cluster->count;
+}
+
+int QtMessageFilterTemplateMiner::templateCount() const
+{
+    return m_template_count.loadAcquire();
+}
+
+quint64 QtMessageFilterTemplateMiner::evictedCount() const
+{
+    return m_evicted.loadAcquire();
+}
+
+QByteArray QtMessageFilterTemplateMiner::reconstruct(const QByteArray& messageTemplate, const QList<QByteArray>& parameters)
+{
+    // Each wildcard token takes the next parameter
+    QByteArray message;
+    int parameter = 0;
+    bool first = true;
+    for(const QByteArray& k : messageTemplate.split(' '))
+    {
+        if(!first)
+            message += ' ';
+        first = false;
+
+        if(k == c_wildcard && parameter < parameters.size())
+            message += parameters.at(parameter++);
+        else
+            message += k;
+    }
+    return message;
+}
+
+bool QtMessageFilterTemplateMiner::f_is_parameter(const QByteArray& token)
+{
+    // A token equal to the wildcard is also a parameter, so the message can be reconstructed
+    if(token == c_wildcard)
+        return true;
+
+    for(const char k : token)
+    {
+        if(k >= '0' && k <= '9')
+            return true;
+    }
+    return false;
+}
+
+void QtMessageFilterTemplateMiner::f_evict_least_recent()
+{
+    // Must be called with m_mutex locked
+    if(m_lru.isEmpty())
+        return;
+
+    const int templateId = m_lru.take(m_lru.firstKey());
+    auto cluster = m_clusters.find(templateId);
+    if(cluster == m_clusters.end())
+        return;
+
+    // The nodes of the tree are kept, they are bounded by the depth and maximumChildren
+    cluster->leaf->clusters.removeOne(templateId);
+    m_clusters.erase(cluster);
+
+    m_template_count.storeRelease(m_clusters.size());
+    m_evicted.fetchAndAddRelaxed(1);
+}
+
+QSharedPointer<QtMessageFilterTemplateMiner::Node> QtMessageFilterTemplateMiner::f_leaf(const QList<QByteArray>& tokens)
+{
+    // Must be called with m_mutex locked
+    QSharedPointer<Node>& root = m_roots[tokens.size()];
+    if(!root)
+        root.reset(new Node());
+
+    // The first tokens choose the path, the parameters and the tokens
+    //  of a full node go on the wildcard path
+    QSharedPointer<Node> node = root;
+    const int pathSize = qMin(m_depth - 2, tokens.size());
+    for(int i = 0; i < pathSize; i++)
+    {
+        const QByteArray& token = tokens.at(i);
+
+        auto child = node->children.find(token);
+        if(child == node->children.end())
+        {
+            if(token != c_wildcard && node->children.size() >= m_maximum_children)
+                child = node->children.find(c_wildcard);
+
+            if(child == node->children.end())
+            {
+                const QByteArray key = node->children.size() < m_maximum_children ? token : c_wildcard;
+                child = node->children.insert(key, QSharedPointer<Node>(new Node()));
+            }
+        }
+        node = child.value();
+    }
+    return node;
+}
@@ -0,0 +1,135 @@
+//
+// MIT License
+//
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+
+#ifndef QTMESSAGEFILTERTEMPLATEMINER_H
+#define QTMESSAGEFILTERTEMPLATEMINER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+
+
+///
+/// \brief This class groups the messages on templates, like "Teste <*>"
+/// \details It is an online version of the Drain algorithm: the message is split
+/// on its spaces (the tokens), the tokens with digits are parameters and the
+/// message is looked for on a tree, first by its count of tokens and then by its
+/// first tokens. The leaf of the tree has some templates (the clusters), the message
+/// joins the most similar one (the fraction of tokens equal on the same position)
+/// when it is similar enough, the tokens of the template that differ from the ones
+/// of the message become parameters ("<*>"). Otherwise a new template is created.
+///
+/// QtMessageFilterTemplateMiner::mine() returns the id of the template of the message
+/// and its parameters, the message is exactly
+/// QtMessageFilterTemplateMiner::reconstruct(template, parameters). Messages with too
+/// many tokens are not mined (the id is -1).
+///
+/// At most maximumTemplates templates are kept, when a new one is needed the least
+/// recently hit is evicted: it is removed from the tree and its id is never used again,
+/// QtMessageFilterTemplateMiner::templateOf() returns an empty text for it. The count of
+/// templates and of evicted ones are atomics, read without the mutex.
+///
+/// It is used by QtMessageFilterLogWriter, on the writer thread, so the threads that
+/// generate the messages never pay for it, and by QtMessageFilterCore::appendMessages()
+/// for the messages that are not written. The mutex protects the templates from the
+/// other miners and from the readers (like the dialog).
+///
+class QtMessageFilterTemplateMiner
+{
+public:
+
+    struct Result
+    {
+        int templateId;
+        bool templateChanged;
+        QList<QByteArray> parameters;
+    };
+
+    explicit QtMessageFilterTemplateMiner(const int depth = 4, const double similarity = 0.4,
+                                          const int maximumChildren = 100, const int maximumTokens = 256,
+                                          const int maximumTemplates = 4096);
+
+    Result mine(const QByteArray& message);
+
+    QByteArray templateOf(const int templateId) const;
+    quint64 countOf(const int templateId) const;
+    int templateCount() const;
+    quint64 evictedCount() const;
+
+    static QByteArray reconstruct(const QByteArray& messageTemplate, const QList<QByteArray>& parameters);
+
+private:
+
+    struct Node
+    {
+        QHash<QByteArray, QSharedPointer<Node>> children;
+
+        // Indexes of m_clusters, only on the leaves
+        QList<int> clusters;
+    };
+
+    struct Cluster
+    {
+        QList<QByteArray> tokens;
+        quint64 count;
+
+        // Its leaf on the tree and its key on m_lru
+        QSharedPointer<Node> leaf;
+        quint64 lastHit;
+    };
+
+    static bool f_is_parameter(const QByteArray& token);
+    QSharedPointer<Node> f_leaf(const QList<QByteArray>& tokens);
+    void f_evict_least_recent();
+
+    const int m_depth;
+    const double m_similarity;
+    const int m_maximum_children;
+    const int m_maximum_tokens;
+    const int m_maximum_templates;
+
+    mutable QMutex m_mutex;
+
+    // First layer of the tree, by count of tokens
+    QHash<int, QSharedPointer<Node>> m_roots;
+
+    // By the id of the template, the ids are never reused
+    QHash<int, Cluster> m_clusters;
+    int m_next_id;
+
+    // Ids of the templates by their last hit, the least recent first
+    QMap<quint64, int> m_lru;
+    quint64 m_hits;
+
+    QAtomicInt m_template_count;
+    QAtomicInteger<quint64> m_evicted;
+};
+
+#endif // QTMESSAGEFILTERTEMPLATEMINER_H
@@ -0,0 +1,262 @@
+// MIT License
+
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "QtMessageFilter/qtmessagefilter.h"
+
+#include <QApplication>
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+
+// Benchmarks of the capture, write and render paths of QtMessageFilter.
+//  Besides the output of QtTest, the results are written as JSON on the
+//  file named by QTMESSAGEFILTER_BENCHMARK_JSON (QtMessageFilterBenchmark.json
+//  by default), so they can be compared across versions.
+//  It runs with the platform "offscreen" unless QT_QPA_PLATFORM is set.
+class BenchmarkQtMessageFilter : public QObject
+{
+    Q_OBJECT
+
+private:
+    QJsonObject m_results;
+    QJsonArray m_capture_latency;
+    QJsonArray m_filter_toggle;
+
+    // Message handler of QtTest, replaced by the one of each test
+    QtMessageHandler m_test_handler;
+
+    static qint64 f_percentile(const std::vector<qint64>& sorted, const double p)
+    {
+        if(sorted.empty())
+            return 0;
+        return sorted[std::min(sorted.size() - 1, (size_t)(p*sorted.size()))];
+    }
+
+private Q_SLOTS:
+
+    void initTestCase()
+    {
+        m_results.insert("qtVersion", QString(qVersion()));
+        m_results.insert("date", QDateTime::currentDateTime().toString(Qt::ISODate));
+    }
+
+    void init()
+    {
+        m_test_handler = qInstallMessageHandler(nullptr);
+        qInstallMessageHandler(m_test_handler);
+    }
+
+    void cleanup()
+    {
+        QtMessageFilter::releaseInstance();
+
+        // QTest::ignoreMessage and the warnings of QtTest need it on the next tests
+        qInstallMessageHandler(m_test_handler);
+    }
+
+    void cleanupTestCase()
+    {
+        m_results.insert("captureLatency", m_capture_latency);
+        m_results.insert("filterToggle", m_filter_toggle);
+
+        QString fileName = qEnvironmentVariable("QTMESSAGEFILTER_BENCHMARK_JSON");
+        if(fileName.isEmpty())
+            fileName = "QtMessageFilterBenchmark.json";
+
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QJsonDocument(m_results).toJson());
+    }
+
+    // Latency of each call of the message handler with 1 to 64 producer threads
+    void captureLatency_data()
+    {
+        QTest::addColumn<int>("threads");
+
+        for(const int threads : {1, 2, 4, 8, 16, 32, 64})
+            QTest::newRow(qPrintable(QString("%1 threads").arg(threads))) << threads;
+    }
+
+    void captureLatency()
+    {
+        QFETCH(int, threads);
+        const int messagesPerThread = 20000/threads + 1000;
+
+        QtMessageFilter::resetInstance(nullptr, true, 100, 10, 256*1024*1024);
+
+        std::atomic<bool> go(false);
+        std::vector<std::vector<qint64>> latencies(threads);
+        std::vector<std::thread> producers;
+
+        for(int t = 0; t < threads; t++)
+        {
+            producers.emplace_back([&go, &latencies, t, messagesPerThread]
+            {
+                std::vector<qint64>& latency = latencies[t];
+                latency.reserve(messagesPerThread);
+
+                while(!go.load())
+                    std::this_thread::yield();
+
+                QElapsedTimer timer;
+                timer.start();
+                for(int i = 0; i < messagesPerThread; i++)
+                {
+                    const qint64 begin = timer.nsecsElapsed();
+                    qDebug("Benchmark message %d of thread %d", i, t);
+                    latency.push_back(timer.nsecsElapsed() - begin);
+                }
+            });
+        }
+
+        go.store(true);
+        for(std::thread& k : producers)
+            k.join();
+
+        std::vector<qint64> all;
+        for(const std::vector<qint64>& k : latencies)
+            all.insert(all.end(), k.begin(), k.end());
+        std::sort(all.begin(), all.end());
+
+        QJsonObject result;
+        result.insert("threads", threads);
+        result.insert("messages", (qint64)all.size());
+        result.insert("p50Ns", f_percentile(all, 0.5));
+        result.insert("p90Ns", f_percentile(all, 0.9));
+        result.insert("p99Ns", f_percentile(all, 0.99));
+        result.insert("p999Ns", f_percentile(all, 0.999));
+        result.insert("maxNs", all.empty() ? 0 : all.back());
+        m_capture_latency.append(result);
+
+        QTest::setBenchmarkResult(f_percentile(all, 0.99), QTest::WalltimeNanoseconds);
+    }
+
+    // Bytes written on the log file per second
+    void logThroughput()
+    {
+        QtMessageFilter::resetInstance(nullptr, true, 100, 10, 64*1024*1024);
+        QtMessageFilterCore::flush();
+        const qint64 sizeBegin = QFileInfo("QtMessageFilterLog.txt").size();
+
+        const QString payload(1024, 'x');
+        const int messages = 20000;
+
+        QElapsedTimer timer;
+        timer.start();
+        for(int i = 0; i < messages; i++)
+            qInfo("%d %s", i, qPrintable(payload));
+        QtMessageFilterCore::flush();
+        const double seconds = timer.nsecsElapsed()/1e9;
+
+        const qint64 bytes = QFileInfo("QtMessageFilterLog.txt").size() - sizeBegin;
+
+        QJsonObject result;
+        result.insert("messages", messages);
+        result.insert("bytes", bytes);
+        result.insert("seconds", seconds);
+        result.insert("megabytesPerSecond", bytes/(1024.0*1024.0)/qMax(seconds, 1e-9));
+        m_results.insert("logThroughput", result);
+    }
+
+    // Cost of creating the items of 1000 messages on the visible dialog
+    void uiInsertion()
+    {
+        QtMessageFilter::resetInstance(nullptr, false, 100, 10, 64*1024*1024);
+        QCoreApplication::processEvents();
+
+        int iterations = 0;
+        QElapsedTimer timer;
+        timer.start();
+        QBENCHMARK
+        {
+            for(int i = 0; i < 1000; i++)
+                qDebug("Benchmark message %d", i);
+            QCoreApplication::processEvents();
+            iterations++;
+        }
+
+        QJsonObject result;
+        result.insert("nsPer1000Messages", timer.nsecsElapsed()/(double)qMax(1, iterations));
+        m_results.insert("uiInsertion", result);
+    }
+
+    // Time to uncheck and check a type of message with many retained messages
+    void filterToggle_data()
+    {
+        QTest::addColumn<int>("retained");
+
+        QTest::newRow("10k") << 10000;
+        QTest::newRow("100k") << 100000;
+        QTest::newRow("1M") << 1000000;
+    }
+
+    void filterToggle()
+    {
+        QFETCH(int, retained);
+
+        QtMessageFilter::resetInstance(nullptr, true, 100, 10, 1024ul*1024*1024);
+        for(int i = 0; i < retained; i++)
+            qDebug("%d", i);
+        QtMessageFilterCore::flush();
+
+        QtMessageFilter::showDialog();
+        QCoreApplication::processEvents();
+
+        int iterations = 0;
+        QElapsedTimer timer;
+        timer.start();
+        QBENCHMARK
+        {
+            QtMessageFilter::setMessageTypeVisible(QtDebugMsg, false);
+            QtMessageFilter::setMessageTypeVisible(QtDebugMsg, true);
+            QCoreApplication::processEvents();
+            iterations++;
+        }
+
+        QJsonObject result;
+        result.insert("retained", retained);
+        result.insert("nsPerToggle", timer.nsecsElapsed()/(double)qMax(1, iterations));
+        m_filter_toggle.append(result);
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    // Headless by default
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    BenchmarkQtMessageFilter benchmark;
+    return QTest::qExec(&benchmark, argc, argv);
+}
+
+#include "benchmark.moc"
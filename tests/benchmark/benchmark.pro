@@ -0,0 +1,45 @@
+# MIT License
+
+# Copyright (c) 2020-2021  Bruno Bollos Correa
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+
+
+# Benchmarks of the capture, write and render paths, run headless with:
+#  ./benchmark
+# The results are also written as JSON on the file named by the environment
+#  variable QTMESSAGEFILTER_BENCHMARK_JSON (QtMessageFilterBenchmark.json by
+#  default).
+
+QT       += core gui testlib
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = benchmark
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../../QtMessageFilter/QtMessageFilter.pri)
+
+SOURCES += \
+    benchmark.cpp
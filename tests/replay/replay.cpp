@@ -0,0 +1,207 @@
+// MIT License
+
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "QtMessageFilter/qtmessagefilter.h"
+#include "QtMessageFilter/qtmessagefilterlogreader.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QHash>
+#include <QVector>
+
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstdio>
+
+
+// Replay of a recorded log file: the messages are read to memory, then sent again
+//  through QMessageLogger with their original type, category and location, so the
+//  dialog and the log file see the same load of the production. The messages of
+//  each recorded thread are replayed in order by the same replay thread, the
+//  recorded threads are spread on the replay threads.
+// The timing can be the original one, N times faster or as fast as possible (speed 0).
+// Fatal messages are replayed as critical ones, so the replay is not aborted.
+
+struct ReplayMessage
+{
+    QtMsgType type;
+
+    // Milliseconds since the first message
+    qint64 time;
+
+    // Kept alive while QMessageLogger points to them
+    QByteArray fileName;
+    int line;
+    QByteArray function;
+    QByteArray category;
+    QByteArray message;
+};
+
+static void f_replay(const QVector<ReplayMessage>* messages, const double speed,
+                     const std::chrono::steady_clock::time_point begin, std::atomic<quint64>* replayed)
+{
+    for(const ReplayMessage& k : *messages)
+    {
+        if(speed > 0)
+            std::this_thread::sleep_until(begin + std::chrono::microseconds((qint64)(k.time*1000/speed)));
+
+        QMessageLogger logger(k.fileName.isEmpty() ? nullptr : k.fileName.constData(), k.line,
+                              k.function.isEmpty() ? nullptr : k.function.constData(),
+                              k.category.isEmpty() ? "default" : k.category.constData());
+
+        switch(k.type)
+        {
+            case QtDebugMsg:
+                logger.debug("%s", k.message.constData());
+                break;
+            case QtInfoMsg:
+                logger.info("%s", k.message.constData());
+                break;
+            case QtWarningMsg:
+                logger.warning("%s", k.message.constData());
+                break;
+            default:
+                logger.critical("%s", k.message.constData());
+                break;
+        }
+
+        replayed->fetch_add(1);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    // The replay ends with the messages, not with the dialog
+    app.setQuitOnLastWindowClosed(false);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays a log file of QtMessageFilter through the message handler");
+    parser.addHelpOption();
+    parser.addPositionalArgument("log", "Log file recorded by QtMessageFilter, text or binary.");
+    parser.addOption(QCommandLineOption("speed", "Speed of the replay, 1 is the original timing and "
+                                                 "0 is as fast as possible.", "factor", "1"));
+    parser.addOption(QCommandLineOption("threads", "Count of threads replaying the messages.", "count", "4"));
+    parser.addOption(QCommandLineOption("hide", "Replay with the dialog hidden."));
+    parser.process(app);
+
+    if(parser.positionalArguments().size() != 1)
+        parser.showHelp(1);
+
+    const QString fileName = parser.positionalArguments().first();
+    const double speed = qMax(0.0, parser.value("speed").toDouble());
+    const int threads = qMax(1, parser.value("threads").toInt());
+
+    // Read everything before the filter is installed, its log file may be the same file
+    QString error;
+    QList<QtMessageFilterLogReader::Record> records = QtMessageFilterLogReader::readBinaryFile(fileName, &error);
+    if(records.isEmpty())
+        records = QtMessageFilterLogReader::readFile(fileName, &error);
+
+    if(!error.isEmpty())
+        fprintf(stderr, "%s: %s\n", qPrintable(fileName), qPrintable(error));
+
+    // Messages of each replay thread, the recorded threads are assigned in the
+    //  order they first appear
+    QVector<QVector<ReplayMessage>> messages(threads);
+    QHash<quintptr, int> threadOfRecord;
+    qint64 first = -1;
+    quint64 count = 0;
+
+    for(const QtMessageFilterLogReader::Record& k : qAsConst(records))
+    {
+        if(k.kind != QtMessageFilterLogReader::Record::Message)
+            continue;
+
+        const qint64 time = k.dateTime.toMSecsSinceEpoch();
+        if(first < 0)
+            first = time;
+
+        auto thread = threadOfRecord.constFind(k.threadId);
+        if(thread == threadOfRecord.constEnd())
+            thread = threadOfRecord.insert(k.threadId, threadOfRecord.size() % threads);
+
+        messages[thread.value()].append(ReplayMessage{k.type, qMax<qint64>(0, time - first),
+                                                      k.fileName.toUtf8(), k.line, k.function.toUtf8(),
+                                                      k.category.toUtf8(), k.message.toUtf8()});
+        count++;
+    }
+    records.clear();
+
+    if(count == 0)
+    {
+        fprintf(stderr, "%s: no message to replay\n", qPrintable(fileName));
+        return 1;
+    }
+
+    QtMessageFilter::resetInstance(nullptr, parser.isSet("hide"));
+
+    std::atomic<quint64> replayed(0);
+    std::atomic<int> running(threads);
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> replayers;
+    for(int i = 0; i < threads; i++)
+    {
+        replayers.emplace_back([&, i]
+        {
+            QThread::currentThread()->setObjectName(QString("replay %1").arg(i));
+            f_replay(&messages.at(i), speed, begin, &replayed);
+
+            // The last thread ends the replay
+            if(running.fetch_sub(1) == 1)
+                QMetaObject::invokeMethod(&app, "quit", Qt::QueuedConnection);
+        });
+    }
+
+    app.exec();
+
+    for(std::thread& k : replayers)
+        k.join();
+
+    const qint64 milliseconds = qMax<qint64>(1, elapsed.elapsed());
+
+    QtMessageFilterCore::flush();
+    const QtMessageFilterCore::Statistics statistics = QtMessageFilterCore::statistics();
+
+    quint64 dropped = 0;
+    for(const quint64 k : statistics.writer.dropped)
+        dropped += k;
+
+    QtMessageFilter::releaseInstance();
+
+    // The message handler is not installed anymore, so print it directly
+    fprintf(stdout, "%llu messages replayed in %lld ms (%.1f msg/s) with %d threads, %llu dropped, "
+                    "%.1f MiB written\n",
+            (unsigned long long)replayed.load(), (long long)milliseconds, replayed.load()*1000.0/milliseconds,
+            threads, (unsigned long long)dropped, statistics.writer.bytesWritten/(1024.0*1024.0));
+
+    return 0;
+}
@@ -0,0 +1,46 @@
+# MIT License
+
+# Copyright (c) 2020-2021  Bruno Bollos Correa
+
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+
+#  The above copyright notice and this permission notice shall be included in all
+#  copies or substantial portions of the Software.
+
+#  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+#  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+#  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+#  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+#  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+#  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+#  SOFTWARE.
+
+
+
+
+# Replays a recorded log file of QtMessageFilter (text or binary) through the
+#  message handler, with:
+#  ./replay QtMessageFilterLog.txt --speed 10 --threads 8
+# Run it on another directory than the one of the recorded log, the log file
+#  of the replay is written on the current directory.
+
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = replay
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../../QtMessageFilter/QtMessageFilter.pri)
+
+SOURCES += \
+    replay.cpp
@@ -0,0 +1,429 @@
+// MIT License
+
+// Copyright (c) 2020-2021  Bruno Bollos Correa
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "QtMessageFilter/qtmessagefilter.h"
+#include "QtMessageFilter/qtmessagefilterlogreader.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QThread>
+#include <QFile>
+#include <QSet>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <random>
+#include <cstdio>
+#include <climits>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+
+// Stress test of QtMessageFilter: many threads generate messages of the four
+//  types with random sizes while the GUI thread toggles the types and shows and
+//  hides the dialog. At the end, the log file is parsed and checked:
+//  * it has no malformed record and it is closed;
+//  * the ids are unique and contiguous;
+//  * the ids are on increasing order;
+//  * every message generated is there, with its full content, type and thread,
+//  compared with the same messages generated again;
+//  * the retained messages are equal to the generated ones;
+//  * the retained messages (ASCII) are charged about their size, not the
+//  3 bytes per character allocated by QString::toUtf8();
+//  * the retained bytes never exceeded the budget;
+//  * the resident memory stayed stable after the warm up (Linux only).
+// It runs with the platform "offscreen" unless QT_QPA_PLATFORM is set, the
+//  exit code is the count of failed checks.
+
+static int s_failures = 0;
+
+static void f_check(const bool condition, const QString& description)
+{
+    // The message handler is not installed anymore, so print it directly
+    fprintf(stdout, "[%s] %s\n", condition ? "PASS" : "FAIL", qPrintable(description));
+    fflush(stdout);
+
+    if(!condition)
+        s_failures++;
+}
+
+static qint64 f_resident_bytes()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if(!statm.open(QIODevice::ReadOnly))
+        return -1;
+
+    // Size and resident pages, the others are not needed
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if(fields.size() < 2)
+        return -1;
+
+    return fields.at(1).toLongLong()*sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
+
+// Messages of a producer, the same index generates the same messages again,
+//  so the checks can compare the content of each one with what was logged
+class MessageGenerator
+{
+public:
+    MessageGenerator(const int index, const int maximumSize)
+        : m_index(index),
+          m_sequence(0),
+          m_random(index*7919 + 1),
+          m_type_distribution(0, 3),
+          m_size_distribution(0, maximumSize),
+          m_char_distribution(0, 63)
+    {}
+
+    QByteArray next(QtMsgType* type)
+    {
+        static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ\n0123456789";
+
+        const int size = m_size_distribution(m_random);
+        QByteArray payload(size, ' ');
+        for(char& k : payload)
+            k = alphabet[m_char_distribution(m_random)];
+
+        // The header tells the producer and the sequence of the message
+        const QByteArray message = "stress " + QByteArray::number(m_index) + ' ' +
+                QByteArray::number(m_sequence++) + ' ' + QByteArray::number(size) + '\n' + payload;
+
+        static const QtMsgType types[] = {QtDebugMsg, QtInfoMsg, QtWarningMsg, QtCriticalMsg};
+        *type = types[m_type_distribution(m_random)];
+
+        return message;
+    }
+
+private:
+    const int m_index;
+    quint64 m_sequence;
+    std::mt19937 m_random;
+    std::uniform_int_distribution<int> m_type_distribution;
+    std::uniform_int_distribution<int> m_size_distribution;
+    std::uniform_int_distribution<int> m_char_distribution;
+};
+
+static void f_producer(const int index, const int maximumSize, std::atomic<bool>* stop,
+                       std::atomic<quint64>* generated, quint64* produced)
+{
+    QThread::currentThread()->setObjectName(QString("stress %1").arg(index));
+
+    MessageGenerator generator(index, maximumSize);
+
+    quint64 sequence = 0;
+    for(; !stop->load(); sequence++)
+    {
+        QtMsgType type = QtDebugMsg;
+        const QByteArray message = generator.next(&type);
+
+        switch(type)
+        {
+            case QtDebugMsg:
+                qDebug("%s", message.constData());
+                break;
+            case QtInfoMsg:
+                qInfo("%s", message.constData());
+                break;
+            case QtWarningMsg:
+                qWarning("%s", message.constData());
+                break;
+            default:
+                qCritical("%s", message.constData());
+                break;
+        }
+        generated[type]++;
+    }
+
+    *produced = sequence;
+}
+
+// Producer and sequence of a message of the stress test, false for the other messages
+static bool f_parse_header(const QString& message, int* index, quint64* sequence)
+{
+    if(!message.startsWith("stress "))
+        return false;
+
+    const QStringList header = message.left(message.indexOf('\n')).split(' ');
+    if(header.size() != 4)
+        return false;
+
+    bool okIndex = false, okSequence = false;
+    *index = header.at(1).toInt(&okIndex);
+    *sequence = header.at(2).toULongLong(&okSequence);
+    return okIndex && okSequence;
+}
+
+int main(int argc, char *argv[])
+{
+    // The log file must have the default format to be parsed
+    qunsetenv("QT_MESSAGE_PATTERN");
+
+    // Headless by default
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Stress test of QtMessageFilter");
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("duration", "Duration of the test in seconds.", "seconds", "10"));
+    parser.addOption(QCommandLineOption("threads", "Count of threads generating messages.", "count", "8"));
+    parser.addOption(QCommandLineOption("max-size", "Maximum size of a message in bytes.", "bytes", "4096"));
+    parser.addOption(QCommandLineOption("budget", "Bytes retained by QtMessageFilterCore.", "bytes", "4194304"));
+    parser.addOption(QCommandLineOption("message-bytes", "Bytes of a message kept on memory.", "bytes", "2048"));
+    parser.addOption(QCommandLineOption("queue", "Capacity of the queue of the log file.", "records", "1024"));
+    parser.process(app);
+
+    const int duration = qMax(1, parser.value("duration").toInt());
+    const int threads = qMax(1, parser.value("threads").toInt());
+    const int maximumSize = qMax(0, parser.value("max-size").toInt());
+    const ulong budget = parser.value("budget").toULong();
+    const ulong messageBytes = parser.value("message-bytes").toULong();
+
+    QtMessageFilter::resetInstance(nullptr, true, 100, 10, budget, messageBytes);
+    QtMessageFilterCore::setWriterQueueCapacity(parser.value("queue").toInt());
+
+    std::atomic<bool> stop(false);
+    // Indexed by QtMsgType
+    std::atomic<quint64> generated[5];
+    for(std::atomic<quint64>& k : generated)
+        k.store(0);
+
+    // Count of messages of each producer, set when it stops
+    std::vector<quint64> produced(threads, 0);
+
+    std::vector<std::thread> producers;
+    for(int i = 0; i < threads; i++)
+        producers.emplace_back(f_producer, i, maximumSize, &stop, generated, &produced[i]);
+
+    // Concurrent use of the dialog and of the core on the GUI thread
+    qint64 maximumRetained = 0;
+    qint64 residentBaseline = -1;
+    qint64 residentPeak = -1;
+    std::mt19937 random(42);
+    int tick = 0;
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    QTimer timer;
+    QObject::connect(&timer, &QTimer::timeout,
+                     [&]
+    {
+        const QtMsgType types[] = {QtDebugMsg, QtInfoMsg, QtWarningMsg, QtCriticalMsg};
+        QtMessageFilter::setMessageTypeVisible(types[random() % 4], random() % 2);
+
+        if(tick % 15 == 0)
+        {
+            if(QtMessageFilter::isDialogVisible())
+                QtMessageFilter::hideDialog();
+            else
+                QtMessageFilter::showDialog();
+        }
+
+        maximumRetained = qMax(maximumRetained, QtMessageFilterCore::retainedBytes());
+
+        // The baseline is the peak of the first quarter, the budget is already full by then
+        const qint64 resident = f_resident_bytes();
+        if(elapsed.elapsed() < duration*1000/4)
+            residentBaseline = qMax(residentBaseline, resident);
+        else
+            residentPeak = qMax(residentPeak, resident);
+
+        if(elapsed.elapsed() >= duration*1000)
+            app.quit();
+
+        tick++;
+    });
+    timer.start(20);
+
+    app.exec();
+
+    stop.store(true);
+    for(std::thread& k : producers)
+        k.join();
+
+    QtMessageFilterCore::flush();
+
+    quint64 dropped = 0;
+    for(const QtMsgType type : {QtDebugMsg, QtInfoMsg, QtWarningMsg, QtCriticalMsg})
+        dropped += QtMessageFilterCore::droppedMessages(type);
+
+    // The retained messages are compared with the generated ones before the
+    //  release, which removes the spill file of the truncated ones
+    {
+        QHash<QPair<int, quint64>, QSharedPointer<MessageDetails>> retained;
+        int oversized = 0;
+        for(const QSharedPointer<MessageDetails>& k : QtMessageFilterCore::lastMessages(INT_MAX))
+        {
+            // The bytes of the message are charged by their capacity
+            if(k->messageUtf8.capacity() > k->messageUtf8.size() + 16)
+                oversized++;
+
+            int index = 0;
+            quint64 sequence = 0;
+            if(f_parse_header(k->message(), &index, &sequence) && index >= 0 && index < threads)
+                retained.insert(qMakePair(index, sequence), k);
+        }
+
+        int mismatches = 0;
+        for(int i = 0; i < threads; i++)
+        {
+            MessageGenerator generator(i, maximumSize);
+            for(quint64 sequence = 0; sequence < produced[i]; sequence++)
+            {
+                QtMsgType type = QtDebugMsg;
+                const QByteArray message = generator.next(&type);
+
+                const QSharedPointer<MessageDetails> details = retained.value(qMakePair(i, sequence));
+                if(details && (details->type != type ||
+                               QtMessageFilterCore::fullMessage(*details) != QString::fromUtf8(message)))
+                {
+                    mismatches++;
+                }
+            }
+        }
+
+        f_check(oversized == 0, QString("Retained messages charged about their size (%1 over)").arg(oversized));
+        f_check(!retained.isEmpty() && mismatches == 0,
+                QString("Retained messages equal to the generated ones (%1 of %2 differ)")
+                .arg(mismatches).arg(retained.size()));
+    }
+
+    // Write the end of the log file
+    QtMessageFilter::releaseInstance();
+
+    f_check(dropped == 0, QString("No message dropped by the queue of the log file (%1)").arg(dropped));
+    f_check(maximumRetained <= (qint64)budget,
+            QString("Retained bytes within the budget (%1 of %2)").arg(maximumRetained).arg(budget));
+
+#ifndef QTMESSAGEFILTER_STRESS_TSAN
+    if(residentBaseline > 0)
+    {
+        const qint64 tolerance = qMax<qint64>(32*1024*1024, residentBaseline/4);
+        f_check(residentPeak <= residentBaseline + tolerance,
+                QString("Resident memory stable (%1 MiB after the warm up, %2 MiB peak)")
+                .arg(residentBaseline/(1024*1024)).arg(residentPeak/(1024*1024)));
+    }
+#endif
+
+    // Parse the log file
+    QFile logFile("QtMessageFilterLog.txt");
+    f_check(logFile.open(QIODevice::ReadOnly), "Log file opened");
+
+    QtMessageFilterLogReader reader;
+    QList<QtMessageFilterLogReader::Record> records;
+    while(!logFile.atEnd())
+        records.append(reader.read(logFile.read(1024*1024)));
+    reader.finish();
+
+    f_check(reader.errors() == 0, QString("Log file parsed cleanly (%1 errors, last: %2)")
+            .arg(reader.errors()).arg(reader.lastError()));
+    f_check(reader.hasBegin() && reader.hasEnd(), "Log file begins and ends");
+
+    QSet<ulong> ids;
+    ulong maximumId = 0;
+    bool idsInOrder = true;
+    quint64 found[5] = {0, 0, 0, 0, 0};
+    int corrupted = 0;
+
+    // Messages of each producer, on the order they are on the log file
+    QVector<QList<const QtMessageFilterLogReader::Record*>> ofProducer(threads);
+
+    for(const QtMessageFilterLogReader::Record& k : qAsConst(records))
+    {
+        if(k.kind != QtMessageFilterLogReader::Record::Message)
+            continue;
+
+        idsInOrder = idsInOrder && (ids.isEmpty() || k.id > maximumId);
+        ids.insert(k.id);
+        maximumId = qMax(maximumId, k.id);
+
+        // Messages of Qt itself are also captured, they only count for the ids
+        if(!k.message.startsWith("stress "))
+            continue;
+
+        int index = 0;
+        quint64 sequence = 0;
+        if(!f_parse_header(k.message, &index, &sequence) || index < 0 || index >= threads || k.type == QtFatalMsg)
+        {
+            corrupted++;
+            continue;
+        }
+
+        ofProducer[index].append(&k);
+        found[k.type]++;
+    }
+
+    // The content, type and order of each message against the generated ones
+    for(int i = 0; i < threads; i++)
+    {
+        MessageGenerator generator(i, maximumSize);
+        const QList<const QtMessageFilterLogReader::Record*>& list = ofProducer.at(i);
+
+        for(quint64 sequence = 0; sequence < produced[i] && sequence < (quint64)list.size(); sequence++)
+        {
+            QtMsgType type = QtDebugMsg;
+            const QByteArray message = generator.next(&type);
+
+            const QtMessageFilterLogReader::Record* record = list.at((int)sequence);
+            if(record->type != type || record->message != QString::fromUtf8(message) ||
+               record->threadName != QString("stress %1").arg(i))
+            {
+                corrupted++;
+            }
+        }
+    }
+
+    quint64 messages = 0;
+    for(const QtMessageFilterLogReader::Record& k : qAsConst(records))
+        messages += k.kind == QtMessageFilterLogReader::Record::Message;
+
+    f_check(ids.size() == (int)messages, QString("Ids are unique (%1 records)").arg(messages));
+    f_check(!ids.isEmpty() && maximumId + 1 == (ulong)ids.size(),
+            QString("Ids are contiguous (0 to %1)").arg(maximumId));
+    f_check(idsInOrder, "Records on the order of their ids");
+    f_check(corrupted == 0, QString("Content of the messages equal to the generated ones (%1 differ)").arg(corrupted));
+
+    const char* typeNames[] = {"debug", "warning", "critical", "fatal", "info"};
+    for(const QtMsgType type : {QtDebugMsg, QtInfoMsg, QtWarningMsg, QtCriticalMsg})
+    {
+        f_check(found[type] == generated[type].load(),
+                QString("Every %1 message on the log file (%2 of %3)")
+                .arg(typeNames[type]).arg(found[type]).arg(generated[type].load()));
+    }
+
+    return s_failures;
+}